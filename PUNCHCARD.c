@@ -29,300 +29,7209 @@
  * program will continue to do this repeatedly until stopped. You can stop the
  * program with Ctrl + C, closing the window, or entering the same start and end
  * time.
+ *
+ * The reading, summing, and rounding of times is done by libpunchcard, which
+ * this file wraps with the prompts, batch mode, and binary punch files.
  */
 
 // Libraries in use:
-#include <stdio.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+// The parsing and arithmetic behind everything this program prints.
+#include "libpunchcard/punchcard.h"
+
+// Reading and writing files, through whichever backend CMakeLists.txt picked.
+#include "io/io.h"
+
+// Memory-mapped files, where the platform has them.
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define PUNCHCARD_MMAP_WINDOWS
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PUNCHCARD_MMAP_POSIX
+#endif
+
+// Serve mode, where the platform has epoll.
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define PUNCHCARD_SERVE
+#endif
+
+// Being told when a followed file changes, where the platform has inotify.
+#if defined(__linux__)
+#include <sys/inotify.h>
+#define PUNCHCARD_INOTIFY
+#endif
+
+// Constants
+
+/**
+ * The number of bytes batch mode reads from its input file at once for each
+ * thread. Batch mode reports any line this long or longer as an error, however
+ * the file is read.
+ */
+#define BATCH_BLOCK_SIZE (1 << 20)
+
+/**
+ * The most threads batch mode will split its work between.
+ */
+#define BATCH_MAX_THREADS 64
+
+/**
+ * The number of tasks each thread's share of a block of batch input is split
+ * into, so a thread finishing early has something to take from the others.
+ */
+#define BATCH_TASKS_PER_THREAD 16
+
+/**
+ * The most characters a single result line from batch mode can take up.
+ */
+#define BATCH_RESULT_SIZE 64
+
+/**
+ * The most fields, each an interval between commas, --recover will split a
+ * line into. A line with more is still reported as unreadable.
+ */
+#define RECOVER_MAX_FIELDS 4096
+
+/**
+ * The number of characters of output collected before writing them out.
+ */
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+/**
+ * The characters every binary punch file starts with.
+ */
+#define BINARY_MAGIC "PNCH"
+
+/**
+ * The version of the binary punch format written by this program.
+ */
+#define BINARY_VERSION 1
+
+/**
+ * The number of bytes in the header at the start of a binary punch file: the
+ * magic characters, the version, and three reserved bytes.
+ */
+#define BINARY_HEADER_SIZE 8
+
+/**
+ * The interval count recorded for a day whose times could not be read.
+ */
+#define BINARY_ERROR_COUNT 0xFFFF
+
+/**
+ * The most intervals a single day can have in a binary punch file.
+ */
+#define BINARY_MAX_INTERVALS 0xFFFE
+
+/**
+ * The longest line of times the interactive prompt will read, including the
+ * newline.
+ */
+#define INTERACTIVE_LINE_SIZE 4096
+
+/**
+ * The longest line of times serve mode will read from a client, including the
+ * newline. Longer lines are answered with ERROR.
+ */
+#define SERVE_LINE_SIZE 4096
+
+/**
+ * The most bytes of answers serve mode holds for a client before it stops
+ * reading the client's requests until they have been sent.
+ */
+#define SERVE_PENDING_LIMIT (1 << 20)
+
+/**
+ * The most events serve mode handles from each wait.
+ */
+#define SERVE_MAX_EVENTS 64
+
+/**
+ * The number of slots the table of employee days starts out with in aggregate
+ * mode. Must be a power of two.
+ */
+#define AGGREGATE_INITIAL_SLOTS (1 << 16)
+
+/**
+ * The number of slots the table of employee IDs starts out with in aggregate
+ * mode. Must be a power of two.
+ */
+#define EMPLOYEE_INITIAL_SLOTS (1 << 10)
+
+/**
+ * The hours a day can hold before the rest is overtime, unless told otherwise.
+ */
+#define ROLLUP_DAILY_OVERTIME 8
+
+/**
+ * The hours a week can hold before the rest is overtime, unless told
+ * otherwise.
+ */
+#define ROLLUP_WEEKLY_OVERTIME 40
+
+/**
+ * The number of weeks in a pay period, unless told otherwise.
+ */
+#define ROLLUP_PERIOD_WEEKS 2
+
+/**
+ * The most weeks a pay period can have.
+ */
+#define ROLLUP_MAX_PERIOD_WEEKS 52
+
+/**
+ * A Monday a pay period starts on, unless told otherwise: 1970-01-05, as the
+ * number of days since 1970-01-01.
+ */
+#define ROLLUP_PERIOD_START 4
+
+/**
+ * How often a followed file is checked for new lines when the platform can't
+ * say when it changes, in seconds.
+ */
+#define FOLLOW_POLL_SECONDS 1
+
+/**
+ * The bytes every checkpoint file starts with.
+ */
+#define CHECKPOINT_MAGIC "PNCK"
+
+/**
+ * The version of the checkpoint file format written.
+ */
+#define CHECKPOINT_VERSION 2
+
+/**
+ * The size of the header at the start of a checkpoint file: the magic bytes,
+ * the version, a byte of flags, two bytes of padding, and then six 64-bit
+ * numbers.
+ */
+#define CHECKPOINT_HEADER_SIZE 56
+
+/**
+ * The number of bytes from the start of the input, and from just before where
+ * a checkpoint was taken, that identify the input it was taken of.
+ */
+#define CHECKPOINT_SAMPLE_SIZE 4096
+
+/**
+ * The flag set in a checkpoint file written while merging overlapping times.
+ */
+#define CHECKPOINT_MERGED 1
+
+/**
+ * The flag set in a checkpoint file written while recovering what could be
+ * read of unreadable lines.
+ */
+#define CHECKPOINT_RECOVERED 2
+
+/**
+ * The size of each employee day stored in a checkpoint file.
+ */
+#define CHECKPOINT_DAY_SIZE 12
+
+/**
+ * The seconds between checkpoints, unless told otherwise.
+ */
+#define CHECKPOINT_SECONDS 60
+
+/**
+ * The bytes every range index file starts with.
+ */
+#define INDEX_MAGIC "PNDX"
+
+/**
+ * The version of the range index file format written.
+ */
+#define INDEX_VERSION 1
+
+/**
+ * The size of the header at the start of a range index file: the magic bytes,
+ * the version, three bytes of padding, and then three 64-bit numbers.
+ */
+#define INDEX_HEADER_SIZE 32
+
+/**
+ * The size of each employee stored in a range index file.
+ */
+#define INDEX_EMPLOYEE_SIZE 16
+
+/**
+ * The size of each employee day stored in a range index file.
+ */
+#define INDEX_DAY_SIZE 20
+
+/**
+ * The most characters the report written by --stats can take up.
+ */
+#define STATISTICS_REPORT_SIZE 1024
+
+/**
+ * What readChar() returns once there is nothing left to read.
+ */
+#define INPUT_END (-1)
+
+/**
+ * Turns the value of a macro into a string, for messages built at compile
+ * time.
+ */
+#define STRINGIFY(x) #x
+#define VALUE_STRING(x) STRINGIFY(x)
+
+// Types
+/**
+ * How the totals for each day are rounded, chosen once at startup.
+ */
+struct Rounding {
+    /**
+     * The policy rounding a total of minutes. Each loop over many totals has a
+     * copy made for every policy, and picks one before it starts.
+     */
+    enum RoundingPolicy policy;
+
+    /**
+     * Whether each interval is rounded before being added up, rather than the
+     * total for the day.
+     */
+    int perInterval;
+};
+
+/**
+ * The reasons a line of times can be counted as unreadable. The first six are
+ * in the same order as the TimeError flags, and match the messages readTime()
+ * prints for them.
+ */
+enum LineError {
+    LINE_HOUR_TOO_SMALL,
+    LINE_HOUR_TOO_BIG,
+    LINE_MINUTE_TOO_SMALL,
+    LINE_MINUTE_TOO_BIG,
+    LINE_BAD_MERIDIEM,
+    LINE_UNREADABLE_TIME,
+    LINE_TOO_LONG,
+    LINE_TOO_MANY_INTERVALS,
+    LINE_BAD_EMPLOYEE_OR_DATE,
+    LINE_ERROR_KINDS
+};
+
+/**
+ * Counts of the lines of times read, kept by whichever thread reads them.
+ */
+struct Counters {
+    /**
+     * The number of lines read, each the times for one day.
+     */
+    uint64_t lines;
+
+    /**
+     * The number of intervals read from lines that could be read.
+     */
+    uint64_t intervals;
+
+    /**
+     * The number of lines that couldn't be read.
+     */
+    uint64_t errorLines;
+
+    /**
+     * The number of problems of each kind found on the lines that couldn't be
+     * read. A time can have more than one thing wrong with it, and a line from
+     * a binary punch file doesn't say why it couldn't be read, so these don't
+     * always add up to errorLines.
+     */
+    uint64_t errors[LINE_ERROR_KINDS];
+};
+
+/**
+ * Everything counted and timed over the whole run, reported by --stats. Only
+ * the main thread reads, writes, and touches these; worker threads keep their
+ * own counters, which are added in as their results are written out.
+ */
+struct Statistics {
+    /**
+     * The lines read on the main thread and collected from the workers.
+     */
+    struct Counters counters;
+
+    /**
+     * The number of bytes read from input files.
+     */
+    uint64_t bytesRead;
+
+    /**
+     * The number of bytes written out.
+     */
+    uint64_t bytesWritten;
+
+    /**
+     * The nanoseconds spent waiting on reads.
+     */
+    uint64_t inputNanoseconds;
+
+    /**
+     * The nanoseconds spent waiting on writes.
+     */
+    uint64_t outputNanoseconds;
+
+    /**
+     * When the run started, in nanoseconds.
+     */
+    uint64_t started;
+};
+
+/**
+ * Output collected in memory so it can be written out in large pieces, rather
+ * than a few characters at a time.
+ */
+struct OutputBuffer {
+    /**
+     * The characters collected so far.
+     */
+    char *data;
+
+    /**
+     * The number of characters collected so far.
+     */
+    size_t length;
+
+    /**
+     * The number of characters the buffer has room for.
+     */
+    size_t capacity;
+
+    /**
+     * The file the buffer is written to when full, or NULL if the buffer
+     * should grow instead.
+     */
+    struct IoFile *stream;
+
+    /**
+     * Whether only the totals for each day should be written.
+     */
+    int quiet;
+
+    /**
+     * How the totals for each day written are rounded.
+     */
+    struct Rounding rounding;
+
+    /**
+     * The counters for the lines whose results are written.
+     */
+    struct Counters *counters;
+
+    /**
+     * Whether to skip only the fields of a line that can't be read, rather
+     * than the whole line.
+     */
+    int recover;
+};
+
+/**
+ * Input read in as large a piece as is available, then handed out a line at a
+ * time.
+ */
+struct InputBuffer {
+    /**
+     * The file being read.
+     */
+    struct IoFile *file;
+
+    /**
+     * The characters read in but not handed out yet, and any before them.
+     */
+    char data[INTERACTIVE_LINE_SIZE];
+
+    /**
+     * The position of the next character to hand out.
+     */
+    size_t position;
+
+    /**
+     * The number of characters read in.
+     */
+    size_t length;
+
+    /**
+     * The number of lines read so far, including blank ones.
+     */
+    size_t lineNumber;
+};
+
+/**
+ * A file mapped read-only into memory.
+ */
+struct InputMapping {
+    /**
+     * The contents of the file, or NULL if it is empty.
+     */
+    const char *data;
+
+    /**
+     * The size of the file.
+     */
+    size_t size;
+};
+
+/**
+ * A function that processes a single line of batch input, writing its result
+ * to an output buffer. The line pointers are both NULL for a line too long to
+ * be read.
+ */
+typedef void (*LineHandler)(const char *line, const char *end,
+                            struct OutputBuffer *output);
+
+/**
+ * What could be read of a line of times that couldn't be read whole, field by
+ * field.
+ */
+struct RecoveredLine {
+    /**
+     * The start and end of each interval read, in minutes since midnight.
+     */
+    uint16_t intervals[RECOVER_MAX_FIELDS][2];
+
+    /**
+     * The offset from the start of the line of each field skipped.
+     */
+    int skipped[RECOVER_MAX_FIELDS];
+
+    /**
+     * The number of intervals read.
+     */
+    int count;
+
+    /**
+     * The number of fields skipped.
+     */
+    int skippedCount;
+};
+
+/**
+ * A run of lines of batch input processed as one piece by whichever worker
+ * thread gets to it first, along with its results. Every task of a block is a
+ * slot in a ring read in input order by a single writer: a worker publishes the
+ * results of a task by storing its sequence number, and the writer copies them
+ * out once the slot's sequence number reaches the one it is waiting for, so no
+ * worker ever waits to hand its results over.
+ */
+struct BatchTask {
+    /**
+     * The first character of the task, at the start of a line.
+     */
+    const char *begin;
+
+    /**
+     * One past the last character of the task, just after a newline.
+     */
+    const char *end;
+
+    /**
+     * The results of the task.
+     */
+    struct OutputBuffer output;
+
+    /**
+     * The counters for the lines of the task, added to the writer's once the
+     * results are written out.
+     */
+    struct Counters counters;
+
+    /**
+     * Whether the output buffer could not grow to hold every result.
+     */
+    int failed;
+
+    /**
+     * The sequence number of the task currently in the slot, which goes up by
+     * the size of the ring with every block.
+     */
+    size_t sequence;
+
+    /**
+     * The sequence number of the last task whose results were published from
+     * the slot.
+     */
+    atomic_size_t published;
+};
+
+/**
+ * A share of a block of batch input given to a single worker thread, along
+ * with the results it produced. The share is split into tasks kept in a
+ * work-stealing deque: the worker takes its own tasks from the bottom, and
+ * once they run out, takes tasks from the top of the other workers' deques,
+ * so the work evens out however unevenly it was spread across the block.
+ */
+struct BatchChunk {
+    /**
+     * The tasks the chunk's share of the block is split into, in input order.
+     */
+    struct BatchTask tasks[BATCH_TASKS_PER_THREAD];
+
+    /**
+     * The first task not yet taken, which other workers take from.
+     */
+    atomic_int top;
+
+    /**
+     * One past the last task not yet taken, which this worker takes from.
+     */
+    atomic_int bottom;
+
+    /**
+     * Every worker splitting the block, for taking tasks from.
+     */
+    struct BatchChunk *workers;
+
+    /**
+     * The number of workers splitting the block.
+     */
+    int workerCount;
+
+    /**
+     * The function processing each line of the chunk.
+     */
+    LineHandler handler;
+};
+
+/**
+ * The total time one employee worked on one date, as kept in the table
+ * aggregate mode fills in. At 16 bytes, four fit in a cache line.
+ */
+struct EmployeeDay {
+    /**
+     * The hash of the employee and date, or 0 if this slot of the table is
+     * empty.
+     */
+    uint32_t hash;
+
+    /**
+     * The index of the employee's ID among those interned.
+     */
+    uint32_t employee;
+
+    /**
+     * The date, as the number of days since 1970-01-01.
+     */
+    int32_t date;
+
+    /**
+     * The total minutes worked.
+     */
+    int32_t minutes;
+};
+
+/**
+ * An employee ID interned by aggregate mode.
+ */
+struct EmployeeId {
+    /**
+     * The offset of the ID among the names of every employee.
+     */
+    uint32_t name;
+
+    /**
+     * The hash of the ID.
+     */
+    uint32_t hash;
+};
+
+/**
+ * Every employee ID aggregate mode has seen, each stored once and referred to
+ * by its index from then on.
+ */
+struct EmployeeIds {
+    /**
+     * The text of every ID, each followed by a null terminator.
+     */
+    char *names;
+
+    /**
+     * The number of characters of names stored.
+     */
+    size_t namesLength;
+
+    /**
+     * The number of characters of names there is room for.
+     */
+    size_t namesCapacity;
+
+    /**
+     * The interned IDs, in the order they were first seen.
+     */
+    struct EmployeeId *ids;
+
+    /**
+     * The number of IDs interned.
+     */
+    size_t count;
+
+    /**
+     * The number of IDs there is room for.
+     */
+    size_t capacity;
+
+    /**
+     * The open-addressed table finding IDs by their text, holding one more
+     * than the index of an ID, or 0 for an empty slot.
+     */
+    uint32_t *slots;
+
+    /**
+     * The number of slots in the table, a power of two.
+     */
+    size_t slotCount;
+};
+
+/**
+ * An employee ID paired with its index, for sorting the IDs by name.
+ */
+struct EmployeeName {
+    /**
+     * The text of the ID.
+     */
+    const char *name;
+
+    /**
+     * The index of the ID.
+     */
+    uint32_t id;
+};
+
+/**
+ * The totals for every employee and date aggregate mode has read.
+ */
+struct Aggregation {
+    /**
+     * Every employee ID seen.
+     */
+    struct EmployeeIds employees;
+
+    /**
+     * The open-addressed table of totals, kept in Robin Hood order: each
+     * entry is no further from its home slot than any entry it passed over.
+     */
+    struct EmployeeDay *days;
+
+    /**
+     * The number of slots in use.
+     */
+    size_t dayCount;
+
+    /**
+     * The number of slots in the table, a power of two.
+     */
+    size_t slotCount;
+
+    /**
+     * The number of lines read so far.
+     */
+    size_t lineNumber;
+
+    /**
+     * The employees and dates changed since they were last written, with
+     * repeats, if changes are being tracked. Only the employee and date of
+     * each is filled in.
+     */
+    struct EmployeeDay *touched;
+
+    /**
+     * The number of changes noted.
+     */
+    size_t touchedCount;
+
+    /**
+     * The number of changes there is room to note.
+     */
+    size_t touchedCapacity;
+
+    /**
+     * Whether changes are being tracked.
+     */
+    int tracking;
+
+    /**
+     * Whether time covered by more than one interval on a line is counted
+     * only once.
+     */
+    int mergeOverlaps;
+
+    /**
+     * Whether to skip only the fields of a line that can't be read, rather
+     * than the whole line.
+     */
+    int recover;
+};
+
+/**
+ * Which file is at a path and how big it is, for telling when a followed file
+ * has been replaced or cut short.
+ */
+struct FileIdentity {
+    /**
+     * The device the file is on.
+     */
+    uint64_t device;
+
+    /**
+     * The file's number on its device.
+     */
+    uint64_t inode;
+
+    /**
+     * The size of the file.
+     */
+    uint64_t size;
+};
+
+/**
+ * Aggregate input read from a file a block at a time, along with any line
+ * left incomplete at the end of what has been read so far.
+ */
+struct AggregateReader {
+    /**
+     * The block of input currently being read.
+     */
+    char *buffer;
+
+    /**
+     * The number of bytes at the start of the buffer holding an incomplete
+     * line carried over from the previous block.
+     */
+    size_t carried;
+
+    /**
+     * Whether the rest of a line too long to read is being skipped.
+     */
+    int discarding;
+
+    /**
+     * The offset in the file of the first byte in the buffer.
+     */
+    uint64_t offset;
+};
+
+/**
+ * The bytes at the start of aggregate input and the last bytes read of it, kept
+ * so a checkpoint can tell whether it is being carried on with the same input.
+ */
+struct InputSample {
+    /**
+     * The first bytes of the input.
+     */
+    char head[CHECKPOINT_SAMPLE_SIZE];
+
+    /**
+     * The number of bytes in head.
+     */
+    size_t headLength;
+
+    /**
+     * The last bytes read of the input.
+     */
+    char tail[CHECKPOINT_SAMPLE_SIZE];
+
+    /**
+     * The number of bytes in tail.
+     */
+    size_t tailLength;
+};
+
+/**
+ * Where and how often aggregate mode saves its progress, so a run that is
+ * stopped partway can carry on from where it was instead of starting over.
+ */
+struct Checkpoint {
+    /**
+     * The path of the checkpoint file.
+     */
+    const char *path;
+
+    /**
+     * The path the checkpoint file is written to before replacing the last
+     * one.
+     */
+    char *temporaryPath;
+
+    /**
+     * The seconds between checkpoints.
+     */
+    int seconds;
+
+    /**
+     * When the last checkpoint was written, or the run started.
+     */
+    time_t last;
+
+    /**
+     * Whether writing a checkpoint has failed, so it is only reported once.
+     */
+    int failed;
+
+    /**
+     * The input read so far, sampled to identify it.
+     */
+    struct InputSample sample;
+
+    /**
+     * The identity of the input the loaded checkpoint was taken of.
+     */
+    uint64_t identity;
+};
+
+/**
+ * The current total for an employee day that changed while following a file.
+ */
+struct ChangedDay {
+    /**
+     * The ID of the employee.
+     */
+    const char *employee;
+
+    /**
+     * The date, as the number of days since 1970-01-01.
+     */
+    int32_t date;
+
+    /**
+     * The total minutes worked.
+     */
+    int32_t minutes;
+};
+
+/**
+ * How aggregate mode rolls employee days up into weeks and pay periods.
+ */
+struct RollupPolicy {
+    /**
+     * The rounded minutes a day can hold before the rest is overtime, or 0 if
+     * there is no daily overtime.
+     */
+    int dailyOvertime;
+
+    /**
+     * The rounded minutes a week can hold, not counting daily overtime, before
+     * the rest is overtime, or 0 if there is no weekly overtime.
+     */
+    int weeklyOvertime;
+
+    /**
+     * The Monday some pay period starts on, as the number of days since
+     * 1970-01-01.
+     */
+    int32_t periodStart;
+
+    /**
+     * The number of weeks in each pay period.
+     */
+    int periodWeeks;
+};
+
+/**
+ * The running totals for the week and pay period of the employee being
+ * reported on. Weeks run from Monday to Sunday and always fall within a
+ * single pay period.
+ */
+struct Rollup {
+    /**
+     * The ID of the employee, or NULL before the first employee.
+     */
+    const char *employee;
+
+    /**
+     * The Monday the week starts on, as the number of days since 1970-01-01.
+     */
+    int32_t weekStart;
+
+    /**
+     * The rounded minutes worked in the week.
+     */
+    int weekMinutes;
+
+    /**
+     * The minutes of daily overtime worked in the week.
+     */
+    int weekDailyOvertime;
+
+    /**
+     * The Monday the pay period starts on, as the number of days since
+     * 1970-01-01.
+     */
+    int32_t periodStart;
+
+    /**
+     * The rounded minutes worked in the pay period.
+     */
+    int periodMinutes;
+
+    /**
+     * The minutes of overtime worked in the pay period.
+     */
+    int periodOvertime;
+};
+
+#if defined(PUNCHCARD_SERVE)
+/**
+ * A client connected to serve mode, along with the requests read from it and
+ * the answers waiting to be sent back.
+ */
+struct ServeClient {
+    /**
+     * The socket connected to the client.
+     */
+    int socket;
+
+    /**
+     * The requests read from the client but not answered yet, at most one of
+     * them incomplete.
+     */
+    char requests[SERVE_LINE_SIZE];
+
+    /**
+     * The number of bytes of requests read but not answered yet.
+     */
+    size_t requestLength;
+
+    /**
+     * Whether the rest of the current request is being thrown away because it
+     * was too long.
+     */
+    int discarding;
+
+    /**
+     * Whether the client has stopped sending requests.
+     */
+    int finished;
+
+    /**
+     * The answers for the client, in the order the requests were read.
+     */
+    struct OutputBuffer answers;
+
+    /**
+     * The line handler answering each request, found once for the rounding the
+     * answers use.
+     */
+    LineHandler handler;
+
+    /**
+     * The number of bytes of answers sent so far.
+     */
+    size_t sent;
+
+    /**
+     * The events currently being waited for on the socket.
+     */
+    uint32_t events;
+};
+#endif
+
+// Tables
+/**
+ * The name of each rounding policy on the command line, in the order of enum
+ * RoundingPolicy.
+ */
+static const char *const roundingNames[] = {"quarter", "quarter-down", "tenth",
+                                            "tenth-down"};
+
+// Statistics
+/**
+ * Everything counted and timed so far. Always kept, however the program was
+ * run, since keeping it costs next to nothing.
+ */
+struct Statistics statistics = {0};
+
+/**
+ * Whether a report of the statistics has been asked for by a signal, and
+ * should be written the next time the main thread reads or writes.
+ */
+volatile sig_atomic_t statisticsRequested = 0;
+
+// Functions
+/**
+ * Reads a clock that only ever moves forward where there is one, and the time
+ * of day otherwise.
+ *
+ * @return The time in nanoseconds, from some fixed point.
+ */
+uint64_t readClock(void) {
+    /**
+     * The time read.
+     */
+    struct timespec now = {0};
+
+#if defined(TIME_MONOTONIC)
+    timespec_get(&now, TIME_MONOTONIC);
+#else
+    timespec_get(&now, TIME_UTC);
+#endif
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Counts each thing wrong with a time, the same way readTime() reports them.
+ *
+ * @param counters The counters to add to.
+ * @param errors   The TimeError flags describing the time.
+ */
+void countTimeErrors(struct Counters *counters, int errors) {
+    if (errors & TIME_MALFORMED) {
+        counters->errors[LINE_UNREADABLE_TIME]++;
+        return;
+    }
+    for (int i = LINE_HOUR_TOO_SMALL; i <= LINE_BAD_MERIDIEM; i++) {
+        if (errors & (1 << i)) {
+            counters->errors[i]++;
+        }
+    }
+}
+
+/**
+ * Counts a line of times that couldn't be read, reading it again to find out
+ * why. Only ever done for unreadable lines, so it costs nothing for the rest.
+ *
+ * @param counters The counters to add to.
+ * @param line     A pointer to the first character of the line, or NULL if
+ *                 the line was too long to be read.
+ * @param end      A pointer one past the last character of the line.
+ */
+void countUnreadableLine(struct Counters *counters, const char *line,
+                         const char *end) {
+    /**
+     * Everything wrong with the first time that couldn't be read.
+     */
+    int errors;
+
+    counters->errorLines++;
+    if (line == NULL) {
+        counters->errors[LINE_TOO_LONG]++;
+        return;
+    }
+
+    // A line whose every time can be read was refused for having too many.
+    errors = findTimeErrors(line, end);
+    if (errors == TIME_OK) {
+        counters->errors[LINE_TOO_MANY_INTERVALS]++;
+    } else {
+        countTimeErrors(counters, errors);
+    }
+}
+
+/**
+ * Adds one set of counters to another.
+ *
+ * @param to   The counters to add to.
+ * @param from The counters to add.
+ */
+void addCounters(struct Counters *to, const struct Counters *from) {
+    to->lines      += from->lines;
+    to->intervals  += from->intervals;
+    to->errorLines += from->errorLines;
+    for (int i = 0; i < LINE_ERROR_KINDS; i++) {
+        to->errors[i] += from->errors[i];
+    }
+}
+
+/**
+ * Writes a JSON name and a count after it.
+ *
+ * @param text  The buffer to write to, with room for the name and 20 digits.
+ * @param name  The name, along with any punctuation around it.
+ * @param value The count to write.
+ *
+ * @return The number of characters written.
+ */
+size_t formatCount(char *text, const char *name, uint64_t value) {
+    /**
+     * The length of the name.
+     */
+    size_t length = strlen(name);
+
+    /**
+     * The digits of the count, from last to first.
+     */
+    char digits[20];
+
+    /**
+     * The number of digits in the count.
+     */
+    size_t count = 0;
+
+    memcpy(text, name, length);
+    do {
+        digits[count++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) {
+        text[length++] = digits[--count];
+    }
+    return length;
+}
+
+/**
+ * Writes every statistic kept so far to stderr as a single line of JSON. The
+ * time spent processing is whatever wasn't spent waiting on reads or writes.
+ */
+void writeStatistics(void) {
+    /**
+     * The name of each kind of error, in the order of enum LineError.
+     */
+    static const char *const errorNames[LINE_ERROR_KINDS] = {
+            "\"hourTooSmall\":", "\"hourTooBig\":", "\"minuteTooSmall\":",
+            "\"minuteTooBig\":", "\"unrecognizedMeridiem\":",
+            "\"unreadableTime\":", "\"lineTooLong\":",
+            "\"tooManyIntervals\":", "\"badEmployeeOrDate\":"};
+
+    /**
+     * The counters being reported.
+     */
+    const struct Counters *counters = &statistics.counters;
+
+    /**
+     * The nanoseconds since the run started.
+     */
+    uint64_t total = readClock() - statistics.started;
+
+    /**
+     * The nanoseconds spent waiting on reads and writes.
+     */
+    uint64_t waiting = statistics.inputNanoseconds +
+                       statistics.outputNanoseconds;
+
+    /**
+     * The report being written.
+     */
+    char text[STATISTICS_REPORT_SIZE];
+
+    /**
+     * The number of characters of the report written so far.
+     */
+    size_t length = 0;
+
+    length += formatCount(text + length, "{\"lines\":", counters->lines);
+    length += formatCount(text + length, ",\"intervals\":",
+                          counters->intervals);
+    length += formatCount(text + length, ",\"errorLines\":",
+                          counters->errorLines);
+    text[length++] = ',';
+    memcpy(text + length, "\"errors\":", 9);
+    length += 9;
+    for (int i = 0; i < LINE_ERROR_KINDS; i++) {
+        text[length++] = i == 0 ? '{' : ',';
+        length += formatCount(text + length, errorNames[i],
+                              counters->errors[i]);
+    }
+    length += formatCount(text + length, "},\"bytesRead\":",
+                          statistics.bytesRead);
+    length += formatCount(text + length, ",\"bytesWritten\":",
+                          statistics.bytesWritten);
+    length += formatCount(text + length, ",\"nanoseconds\":{\"input\":",
+                          statistics.inputNanoseconds);
+    length += formatCount(text + length, ",\"processing\":",
+                          total > waiting ? total - waiting : 0);
+    length += formatCount(text + length, ",\"output\":",
+                          statistics.outputNanoseconds);
+    length += formatCount(text + length, ",\"total\":", total);
+    memcpy(text + length, "}}\n", 3);
+    length += 3;
+    ioWrite(ioStandardError(), text, length);
+}
+
+/**
+ * Asks for the statistics to be written, from a signal handler. Writing them
+ * from here isn't safe, so it's left for the main thread to notice.
+ *
+ * @param signal The signal received.
+ */
+void requestStatistics(int signal) {
+    (void) signal;
+    statisticsRequested = 1;
+}
+
+/**
+ * Writes the statistics if a signal has asked for them since they were last
+ * written. Called by the main thread whenever it reads or writes.
+ */
+void writeRequestedStatistics(void) {
+    if (statisticsRequested) {
+        statisticsRequested = 0;
+        writeStatistics();
+    }
+}
+
+/**
+ * Sets up an empty output buffer.
+ *
+ * @param output   The output buffer to set up.
+ * @param stream   The file to write the buffer to when full, or NULL if the
+ *                 buffer should grow instead.
+ * @param capacity The number of characters to set aside room for.
+ *
+ * @return 0 if the buffer was set up, -1 if there wasn't enough memory.
+ */
+int outputOpen(struct OutputBuffer *output, struct IoFile *stream,
+               size_t capacity) {
+    output->data     = malloc(capacity);
+    output->length   = 0;
+    output->capacity = output->data == NULL ? 0 : capacity;
+    output->stream   = stream;
+    output->quiet    = 0;
+    output->rounding = (struct Rounding) {ROUND_QUARTER_HOUR, 0};
+    output->counters = &statistics.counters;
+    output->recover  = 0;
+    return output->data == NULL ? -1 : 0;
+}
+
+/**
+ * Writes everything collected in an output buffer to its stream and empties
+ * it. Does nothing for buffers without a stream.
+ *
+ * @param output The output buffer to flush.
+ */
+void outputFlush(struct OutputBuffer *output) {
+    if (output->stream != NULL && output->length > 0) {
+        /**
+         * When the write started.
+         */
+        uint64_t started = readClock();
+
+        ioWrite(output->stream, output->data, output->length);
+        statistics.outputNanoseconds += readClock() - started;
+        statistics.bytesWritten      += output->length;
+        output->length = 0;
+        writeRequestedStatistics();
+    }
+}
+
+/**
+ * Writes out everything collected in an output buffer and frees it.
+ *
+ * @param output The output buffer to close.
+ */
+void outputClose(struct OutputBuffer *output) {
+    outputFlush(output);
+    free(output->data);
+    output->data     = NULL;
+    output->capacity = 0;
+}
+
+/**
+ * Makes sure an output buffer has room for more characters, flushing or
+ * growing it as needed.
+ *
+ * @param output The output buffer to make room in.
+ * @param needed The number of characters to make room for.
+ *
+ * @return 0 if there is room, -1 if the buffer could not grow.
+ */
+int outputReserve(struct OutputBuffer *output, size_t needed) {
+    /**
+     * The size the buffer is growing to.
+     */
+    size_t grownCapacity;
+
+    /**
+     * The grown buffer.
+     */
+    char *grown;
+
+    if (output->capacity - output->length >= needed) {
+        return 0;
+    }
+
+    // Make room by writing out what we have, if we can.
+    if (output->stream != NULL) {
+        outputFlush(output);
+        if (output->capacity >= needed) {
+            return 0;
+        }
+    }
+
+    // Otherwise, grow.
+    grownCapacity = output->capacity * 2 + needed;
+    grown         = realloc(output->data, grownCapacity);
+    if (grown == NULL) {
+        return -1;
+    }
+    output->data     = grown;
+    output->capacity = grownCapacity;
+    return 0;
+}
+
+/**
+ * Adds characters to an output buffer.
+ *
+ * @param output The output buffer to add to.
+ * @param text   The characters to add.
+ * @param length The number of characters to add.
+ */
+void outputText(struct OutputBuffer *output, const char *text, size_t length) {
+    // Write large pieces straight through rather than copying them.
+    if (output->stream != NULL && length >= output->capacity) {
+        /**
+         * When the write started.
+         */
+        uint64_t started;
+
+        outputFlush(output);
+        started = readClock();
+        ioWrite(output->stream, text, length);
+        statistics.outputNanoseconds += readClock() - started;
+        statistics.bytesWritten      += length;
+        return;
+    }
+    if (outputReserve(output, length) == 0) {
+        memcpy(output->data + output->length, text, length);
+        output->length += length;
+    }
+}
+
+/**
+ * Adds a string to an output buffer.
+ *
+ * @param output The output buffer to add to.
+ * @param text   The null-terminated string to add.
+ */
+void outputString(struct OutputBuffer *output, const char *text) {
+    outputText(output, text, strlen(text));
+}
+
+/**
+ * Adds a single character to an output buffer.
+ *
+ * @param output    The output buffer to add to.
+ * @param character The character to add.
+ */
+void outputChar(struct OutputBuffer *output, char character) {
+    if (outputReserve(output, 1) == 0) {
+        output->data[output->length++] = character;
+    }
+}
+
+/**
+ * Adds a number to an output buffer in decimal, padded with leading zeroes to
+ * at least the given width the same way "%02d" would be.
+ *
+ * @param output The output buffer to add to.
+ * @param value  The number to add.
+ * @param width  The fewest digits to write.
+ */
+void outputNumber(struct OutputBuffer *output, int value, int width) {
+    /**
+     * The number written out.
+     */
+    char text[NUMBER_TEXT_SIZE];
+
+    outputText(output, text, formatNumber(text, value, width));
+}
+
+/**
+ * Adds a number of minutes to an output buffer as decimal hours with two
+ * places, the same way "%0.2f" would write them as a fraction of an hour.
+ *
+ * @param output  The output buffer to add to.
+ * @param minutes The minutes to add.
+ */
+void outputHours(struct OutputBuffer *output, int minutes) {
+    /**
+     * The hours written out.
+     */
+    char text[NUMBER_TEXT_SIZE];
+
+    outputText(output, text, formatHours(text, minutes));
+}
+
+/**
+ * Writes a message to stderr straight away, with an optional detail, such as a
+ * path, in the middle of it.
+ *
+ * @param before The part of the message before the detail.
+ * @param detail The detail, or NULL if there isn't one.
+ * @param after  The part of the message after the detail, or NULL if there
+ *               isn't one.
+ */
+void printError(const char *before, const char *detail, const char *after) {
+    /**
+     * The file the message is written to.
+     */
+    struct IoFile *error = ioStandardError();
+
+    ioWrite(error, before, strlen(before));
+    if (detail != NULL) {
+        ioWrite(error, detail, strlen(detail));
+    }
+    if (after != NULL) {
+        ioWrite(error, after, strlen(after));
+    }
+}
+
+/**
+ * Reads in as many characters as are available once everything read in before
+ * has been handed out.
+ *
+ * @param input The input buffer to read into.
+ *
+ * @return The number of characters read in, or 0 if there was nothing left.
+ */
+size_t fillInput(struct InputBuffer *input) {
+    /**
+     * When the read started.
+     */
+    uint64_t started = readClock();
+
+    input->position = 0;
+    input->length   = ioRead(input->file, input->data, sizeof(input->data));
+    statistics.inputNanoseconds += readClock() - started;
+    statistics.bytesRead        += input->length;
+    writeRequestedStatistics();
+    return input->length;
+}
+
+/**
+ * Hands out the next character from an input buffer, reading more in if
+ * needed.
+ *
+ * @param input The input buffer to read from.
+ *
+ * @return The character, or INPUT_END if there was nothing left.
+ */
+int readChar(struct InputBuffer *input) {
+    if (input->position == input->length && fillInput(input) == 0) {
+        return INPUT_END;
+    }
+    return (unsigned char) input->data[input->position++];
+}
+
+/**
+ * Consumes any unwanted characters in the input buffer until finding the end of
+ * the input, a newline, or the target character.
+ *
+ * @param input  The input buffer to consume characters from.
+ * @param target The target char to stop consuming characters after
+ * encountering.
+ *
+ * @return -1 if stopped by the end of the input, 1 if stopped by a newline, 0
+ * if stopped by the target character, and 2 otherwise.
+ */
+int clearBufferJunk(struct InputBuffer *input, char target) {
+    /**
+     * The last character returned by readChar().
+     */
+    int lastCharacter;
+
+    // Consume characters until we encounter a stop condition.
+    while ((lastCharacter = readChar(input)) != target &&
+           lastCharacter != INPUT_END && lastCharacter != '\n') {}
+
+    // Return an int signifying the reason for stopping.
+    if (lastCharacter == INPUT_END) {
+        return -1;
+    } else if (lastCharacter == target && target != '\n') {
+        return 0;
+    } else if (lastCharacter == '\n') {
+        return 1;
+    } else {
+        return 2;
+    }
+}
+
+/**
+ * Attempts to read the next available time from a line of input, in the format
+ * HH:MMcc, where HH is the hour, MM is the minute, and cc is the meridiem
+ * indicator ("am" or "pm"). Explains anything wrong with the time read.
+ *
+ * @param cursor   A pointer to the pointer walking the line.
+ * @param end      A pointer one past the last character of the line.
+ * @param hour     A pointer to the int storing the hour for this time.
+ * @param minute   A pointer to the int storing the minute for this time.
+ * @param meridiem A pointer to the char storing the meridiem indicator for this
+ *                 time.
+ * @param output   The output buffer to explain any problems with the time in.
+ *
+ * @return 0 if a valid time was read, -1 if something wasn't right with the
+ *         read time.
+ */
+int readTime(const char **cursor, const char *end, int *hour, int *minute,
+             char *meridiem, struct OutputBuffer *output) {
+    /**
+     * Everything wrong with the time read.
+     */
+    int errors = parseTime(cursor, end, hour, minute, meridiem);
+
+    // If we got what looks like a valid time, return 0.
+    if (errors == TIME_OK) {
+        return 0;
+    }
+    countTimeErrors(output->counters, errors);
+
+    // Else, print a message explaining what was wrong, return -1.
+    if (errors & TIME_MALFORMED) {
+        outputString(output, "[ERROR]\tUNREADABLE TIME: should look like "
+                             "\"HH:MMam\" or \"HH:MMpm\".\n");
+        return -1;
+    }
+    if (errors & TIME_HOUR_TOO_SMALL) {
+        outputString(output, "[ERROR]\tHOUR TOO SMALL: \"");
+        outputNumber(output, *hour, 1);
+        outputString(output, "\", should be greater than 0.\n");
+    }
+    if (errors & TIME_HOUR_TOO_BIG) {
+        outputString(output, "[ERROR]\tHOUR TOO BIG: \"");
+        outputNumber(output, *hour, 1);
+        outputString(output, "\", should be less than 13.\n");
+    }
+    if (errors & TIME_MINUTE_TOO_SMALL) {
+        outputString(output, "[ERROR]\tMINUTE TOO SMALL: \"");
+        outputNumber(output, *minute, 1);
+        outputString(output, "\", should be greater than -1.\n");
+    }
+    if (errors & TIME_MINUTE_TOO_BIG) {
+        outputString(output, "[ERROR]\tMINUTE TOO BIG: \"");
+        outputNumber(output, *minute, 1);
+        outputString(output, "\", should be less than 60.\n");
+    }
+    if (errors & TIME_BAD_MERIDIEM) {
+        outputString(output, "[ERROR]\tUNRECOGNIZED MERIDIEM: \"");
+        outputChar(output, *meridiem);
+        outputString(output, "m\", should be \"am\" or \"pm\".\n");
+    }
+    return -1;
+}
+
+/**
+ * Reads the next line of input that has anything other than whitespace on it.
+ * Lines too long to fit are cut short, and the rest of them discarded.
+ *
+ * @param input    The input buffer to read the line from.
+ * @param line     The buffer to store the line in.
+ * @param capacity The size of the buffer.
+ * @param end      A pointer to the pointer to store the end of the line in,
+ *                 one past its last character.
+ *
+ * @return 0 if a line was read, -1 if the end of the input was reached first.
+ */
+int readLine(struct InputBuffer *input, char *line, size_t capacity,
+             const char **end) {
+    // Until we find a line worth returning...
+    while (1) {
+        /**
+         * The number of characters of the line copied so far.
+         */
+        size_t length = 0;
+
+        /**
+         * The position in the line being read.
+         */
+        const char *cursor = line;
+
+        // Copy characters up to and including the newline, as far as they fit.
+        while (length + 1 < capacity &&
+               (length == 0 || line[length - 1] != '\n')) {
+            /**
+             * The characters read in but not handed out yet.
+             */
+            const char *available = input->data + input->position;
+
+            /**
+             * The number of characters to copy this time around.
+             */
+            size_t count = input->length - input->position;
+
+            /**
+             * The newline among the available characters, if there is one.
+             */
+            const char *newline;
+
+            if (count == 0) {
+                if (fillInput(input) == 0) {
+                    break;
+                }
+                continue;
+            }
+            newline = memchr(available, '\n', count);
+            if (newline != NULL) {
+                count = (size_t) (newline - available) + 1;
+            }
+            if (count > capacity - 1 - length) {
+                count = capacity - 1 - length;
+            }
+            memcpy(line + length, available, count);
+            input->position += count;
+            length += count;
+        }
+        if (length == 0) {
+            return -1;
+        }
+        *end = line + length;
+        input->lineNumber++;
+
+        // If the line didn't fit, throw away the rest of it.
+        if ((*end)[-1] != '\n') {
+            clearBufferJunk(input, '\n');
+        }
+
+        // Return the line if there's anything on it.
+        skipBufferSpace(&cursor, *end);
+        if (cursor != *end) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * Skips an interval of interactive input that couldn't be read, up to and past
+ * the next comma, and says where it was.
+ *
+ * @param output     The output buffer to say where the interval was in.
+ * @param lineNumber The number of the line, counting from 1.
+ * @param line       A pointer to the first character of the line.
+ * @param field      A pointer to the first character of the interval.
+ * @param end        A pointer one past the last character of the line.
+ * @param cursor     A pointer to the pointer walking the line, moved past the
+ *                   comma.
+ *
+ * @return 0 if there is another interval after it, -1 if it was the last.
+ */
+int skipInteractiveField(struct OutputBuffer *output, size_t lineNumber,
+                         const char *line, const char *field, const char *end,
+                         const char **cursor) {
+    /**
+     * The comma ending the interval, if there is one.
+     */
+    const char *comma = memchr(field, ',', end - field);
+
+    outputString(output, "[WARNING]\tSKIPPED UNREADABLE TIME ON LINE ");
+    outputNumber(output, (int) lineNumber, 1);
+    outputString(output, ", COLUMN ");
+    outputNumber(output, (int) (field - line) + 1, 1);
+    outputString(output, ".\n");
+    if (comma == NULL) {
+        *cursor = end;
+        return -1;
+    }
+    *cursor = comma + 1;
+    return 0;
+}
+
+/**
+ * Rounds a single total by a rounding policy, for the few places that round
+ * one total at a time rather than a whole run of them.
+ *
+ * @param rounding How to round the total.
+ * @param minutes  The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundMinutes(const struct Rounding *rounding, int minutes) {
+    switch (rounding->policy) {
+#define ROUND_BY(name, policy, step, firstUp) \
+        case policy: \
+            return roundToStep(minutes, step, firstUp);
+        ROUNDING_POLICIES(ROUND_BY)
+#undef ROUND_BY
+    }
+    return roundQuarterHour(minutes);
+}
+
+/**
+ * Reads an unspecified number of work start and end times separated by commas.
+ * Calculates the time between each and adds that time to the total being
+ * tracked for the day.
+ *
+ * @param totalMinutes   A pointer to the int storing the total minutes worked
+ *                       for the day.
+ * @param roundedMinutes A pointer to the int storing the total of each
+ *                       interval rounded on its own, added to only if the
+ *                       output buffer's rounding is per interval.
+ * @param input          The input buffer to read the times from.
+ * @param output         The output buffer to print the times read back to.
+ *                       If it is set to recover, an interval that can't be
+ *                       read is skipped rather than the whole line.
+ *
+ * @return 1 if all times were successfully read, 0 if a time indicating the
+ * program should end was read or there was no more input, -1 if there was an
+ * issue reading any of the times.
+ */
+int readTimesForDay(int *totalMinutes, int *roundedMinutes,
+                    struct InputBuffer *input, struct OutputBuffer *output) {
+    /**
+     * The line of times being read.
+     */
+    char line[INTERACTIVE_LINE_SIZE];
+
+    /**
+     * One past the last character of the line.
+     */
+    const char *end;
+
+    /**
+     * The position in the line being read.
+     */
+    const char *cursor = line;
+
+    /**
+     * The return value of skipBufferJunk().
+     */
+    int endFound = 0;
+
+    // Make sure the prompt is showing, then read the whole line in at once,
+    // stopping if there's nothing left.
+    outputFlush(output);
+    if (readLine(input, line, INTERACTIVE_LINE_SIZE, &end) == -1) {
+        return 0;
+    }
+    output->counters->lines++;
+
+    // While we haven't hit the end of the line...
+    while (endFound != 1 && endFound != -1) {
+        // Declare our variables...
+        /**
+         * The hour work was started at (12-hour time).
+         */
+        int startHour;
+
+        /**
+         * The minute work was started at.
+         */
+        int startMinute;
+
+        /**
+         * The first character of the meridiem indicator for the time work was
+         * started at ('a' or 'p').
+         */
+        char startMeridiem;
+
+        /**
+         * The hour work ended at (12-hour time).
+         */
+        int endHour;
+
+        /**
+         * The minute work ended at.
+         */
+        int endMinute;
+
+        /**
+         * The first character of the meridiem indicator for the time work
+         * ended at ('a' or 'p').
+         */
+        char endMeridiem;
+
+        /**
+         * The time work was started at, in minutes since midnight.
+         */
+        uint16_t start;
+
+        /**
+         * The time work ended at, in minutes since midnight.
+         */
+        uint16_t stop;
+
+        /**
+         * The number of minutes between the start time and end time.
+         */
+        int minutesWorked;
+
+        /**
+         * The first character of the interval, for saying where it was if it
+         * has to be skipped.
+         */
+        const char *field;
+
+        skipBufferSpace(&cursor, end);
+        field = cursor;
+
+        // Read the start time. If something went wrong...
+        if (readTime(&cursor, end, &startHour, &startMinute, &startMeridiem,
+                     output) == -1) {
+            // Skip just this interval if asked to.
+            if (output->recover) {
+                endFound = skipInteractiveField(output, input->lineNumber,
+                                                line, field, end, &cursor);
+                continue;
+            }
+
+            // Give up on this line and try again.
+            outputString(output,
+                         "Something was wrong with your given start time!\n");
+            output->counters->errorLines++;
+            return -1;
+        }
+
+        // Skip anything particularly annoying between the two times.
+        skipBufferJunk(&cursor, end, '-');
+
+        // Read the end time. If something went wrong...
+        if (readTime(&cursor, end, &endHour, &endMinute, &endMeridiem,
+                     output) == -1) {
+            // Skip just this interval if asked to.
+            if (output->recover) {
+                endFound = skipInteractiveField(output, input->lineNumber,
+                                                line, field, end, &cursor);
+                continue;
+            }
+
+            // Give up on this line and try again.
+            outputString(output,
+                         "Something was wrong with your given end time!\n");
+            output->counters->errorLines++;
+            return -1;
+        }
+
+        // Print the times read back, for confirmation/debugging reasons.
+        if (!output->quiet) {
+            outputString(output, "\nSTART:\t");
+            outputNumber(output, startHour, 2);
+            outputChar(output, ':');
+            outputNumber(output, startMinute, 2);
+            outputChar(output, startMeridiem);
+            outputString(output, "m\nEND:\t");
+            outputNumber(output, endHour, 2);
+            outputChar(output, ':');
+            outputNumber(output, endMinute, 2);
+            outputChar(output, endMeridiem);
+            outputString(output, "m\n");
+        }
+
+        // Convert both times to minutes since midnight.
+        start = toMinutes(startHour, startMinute, startMeridiem);
+        stop  = toMinutes(endHour, endMinute, endMeridiem);
+
+        // If the start time and end time are identical...
+        if (start == stop) {
+            // Stop the program, we're done here.
+            return 0;
+        }
+
+        // Calculate the difference and add it to the total for today.
+        minutesWorked = difference(start, stop);
+        *totalMinutes += minutesWorked;
+        if (output->rounding.perInterval) {
+            *roundedMinutes += roundMinutes(&output->rounding,
+                                            minutesWorked);
+        }
+        output->counters->intervals++;
+
+        // Print the time worked.
+        if (!output->quiet) {
+            outputString(output, "ACTUAL TIME:\t");
+            outputNumber(output, minutesWorked / 60, 2);
+            outputString(output, " hours and ");
+            outputNumber(output, minutesWorked % 60, 2);
+            outputString(output, " minutes.\n");
+        }
+
+        // Move to the next time if possible.
+        endFound = skipBufferJunk(&cursor, end, ',');
+    }
+    return 1;
+}
+
+/**
+ * Writes the result line batch mode prints for a day, once its total has been
+ * rounded: the actual total time as HH:MM and the rounded total hours separated
+ * by a tab.
+ *
+ * @param output         The output buffer to write the result line to.
+ * @param totalMinutes   The total minutes worked for the day.
+ * @param roundedMinutes The total minutes worked for the day, rounded.
+ */
+void outputRoundedDayResult(struct OutputBuffer *output, int totalMinutes,
+                            int roundedMinutes) {
+    outputNumber(output, totalMinutes / 60, 2);
+    outputChar(output, ':');
+    outputNumber(output, totalMinutes % 60, 2);
+    outputChar(output, '\t');
+    outputHours(output, roundedMinutes);
+    outputChar(output, '\n');
+}
+
+/**
+ * Writes the result line batch mode prints for a day with overlapping intervals
+ * merged: the same as outputRoundedDayResult(), followed by a tab, OVERLAP, and
+ * the time counted only once as HH:MM if any intervals overlapped.
+ *
+ * @param output         The output buffer to write the result line to.
+ * @param day            The merged totals for the day.
+ * @param roundedMinutes The merged total for the day, rounded.
+ */
+void outputMergedDayResult(struct OutputBuffer *output,
+                           const struct MergedDay *day, int roundedMinutes) {
+    outputNumber(output, day->minutes / 60, 2);
+    outputChar(output, ':');
+    outputNumber(output, day->minutes % 60, 2);
+    outputChar(output, '\t');
+    outputHours(output, roundedMinutes);
+    if (day->conflicts > 0) {
+        outputString(output, "\tOVERLAP\t");
+        outputNumber(output, day->overlapMinutes / 60, 2);
+        outputChar(output, ':');
+        outputNumber(output, day->overlapMinutes % 60, 2);
+    }
+    outputChar(output, '\n');
+}
+
+/**
+ * Reads what can be read of a line of times that couldn't be read whole,
+ * skipping every field between commas that can't be read, and counts what was
+ * wrong with each field skipped.
+ *
+ * @param recovered The struct RecoveredLine to store what was read in.
+ * @param line      A pointer to the first character of the line.
+ * @param end       A pointer one past the last character of the line.
+ * @param counters  The counters to count the fields skipped in.
+ *
+ * @return 0 if the line was split into fields, -1 if it had too many.
+ */
+int recoverLine(struct RecoveredLine *recovered, const char *line,
+                const char *end, struct Counters *counters) {
+    recovered->count = recoverIntervalsInLine(line, end, recovered->intervals,
+                                              recovered->skipped,
+                                              RECOVER_MAX_FIELDS,
+                                              &recovered->skippedCount);
+    if (recovered->count == -1) {
+        return -1;
+    }
+
+    // Find out what was wrong with each field skipped, as far as its comma.
+    for (int i = 0; i < recovered->skippedCount; i++) {
+        /**
+         * The first character of the field.
+         */
+        const char *field = line + recovered->skipped[i];
+
+        /**
+         * The comma ending the field, if there is one.
+         */
+        const char *comma = memchr(field, ',', end - field);
+
+        countTimeErrors(counters,
+                        findTimeErrors(field, comma != NULL ? comma : end));
+    }
+    return 0;
+}
+
+/**
+ * Sums the intervals read from a line field by field.
+ *
+ * @param recovered      The intervals read.
+ * @param rounding       How to round each interval, or NULL if only the actual
+ *                       time is being summed.
+ * @param roundedMinutes A pointer to the int storing the total of the rounded
+ *                       intervals, or NULL if rounding is.
+ *
+ * @return The total minutes worked.
+ */
+int sumRecoveredLine(const struct RecoveredLine *recovered,
+                     const struct Rounding *rounding, int *roundedMinutes) {
+    /**
+     * The total minutes worked so far.
+     */
+    int totalMinutes = 0;
+
+    for (int i = 0; i < recovered->count; i++) {
+        /**
+         * The minutes worked in this interval.
+         */
+        int worked = difference(recovered->intervals[i][0],
+                                recovered->intervals[i][1]);
+
+        totalMinutes += worked;
+        if (rounding != NULL) {
+            *roundedMinutes += roundMinutes(rounding, worked);
+        }
+    }
+    return totalMinutes;
+}
+
+/**
+ * Adds the column of each field skipped on a line to the end of the result just
+ * written for it: a tab, "SKIPPED", a tab, and the columns, counting from 1,
+ * separated by commas.
+ *
+ * @param output    The output buffer the result line was just written to, which
+ *                  still ends with its newline.
+ * @param recovered What was read of the line.
+ */
+void outputSkippedFields(struct OutputBuffer *output,
+                         const struct RecoveredLine *recovered) {
+    // Go back over the newline, which is never written out on its own.
+    output->length--;
+    outputString(output, "\tSKIPPED");
+    for (int i = 0; i < recovered->skippedCount; i++) {
+        outputChar(output, i == 0 ? '\t' : ',');
+        outputNumber(output, recovered->skipped[i] + 1, 1);
+    }
+    outputChar(output, '\n');
+}
+
+/**
+ * Writes the result for a line of batch input that couldn't be read whole,
+ * from whatever fields of it could be. The line is only reported as
+ * unreadable if it has too many fields, or too many intervals to merge.
+ *
+ * @param line          A pointer to the first character of the line.
+ * @param end           A pointer one past the last character of the line.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ * @param output        The output buffer to write the result to.
+ */
+void processRecoveredBatchLine(const char *line, const char *end,
+                               int mergeOverlaps,
+                               struct OutputBuffer *output) {
+    /**
+     * What could be read of the line, kept off the stack since it is large.
+     */
+    static thread_local struct RecoveredLine recovered;
+
+    /**
+     * The total of each interval worked this day, rounded on its own.
+     */
+    int roundedMinutes = 0;
+
+    /**
+     * The total minutes worked this day.
+     */
+    int totalMinutes;
+
+    if (recoverLine(&recovered, line, end, output->counters) == -1 ||
+        (mergeOverlaps && recovered.count > MERGE_MAX_INTERVALS)) {
+        countUnreadableLine(output->counters, line, end);
+        outputText(output, "ERROR\n", 6);
+        return;
+    }
+    output->counters->intervals += (uint64_t) recovered.count;
+
+    // Write the result the same way as for a line read whole.
+    if (mergeOverlaps) {
+        /**
+         * The merged totals for this day.
+         */
+        struct MergedDay day;
+
+        mergeIntervals(recovered.intervals, recovered.count, &day);
+        outputMergedDayResult(output, &day,
+                              roundMinutes(&output->rounding, day.minutes));
+    } else if (output->rounding.perInterval) {
+        totalMinutes = sumRecoveredLine(&recovered, &output->rounding,
+                                        &roundedMinutes);
+        outputRoundedDayResult(output, totalMinutes, roundedMinutes);
+    } else {
+        totalMinutes = sumRecoveredLine(&recovered, NULL, NULL);
+        outputRoundedDayResult(output, totalMinutes,
+                               roundMinutes(&output->rounding, totalMinutes));
+    }
+    if (recovered.skippedCount > 0) {
+        outputSkippedFields(output, &recovered);
+    }
+}
+
+/**
+ * Processes a single line of batch input, writing the result line for the day,
+ * or ERROR if any of the times on the line could not be read. Inlined into the
+ * copy made for each rounding policy by BATCH_LINE_HANDLERS(), which passes
+ * the policy's own function and its step and threshold as constants.
+ *
+ * @param line          A pointer to the first character of the line, or NULL
+ *                      if the line was too long to read.
+ * @param end           A pointer one past the last character of the line, not
+ *                      including the newline.
+ * @param output        The output buffer to write the result line to.
+ * @param roundInterval The function rounding by the policy.
+ * @param step          The step the policy rounds to a multiple of.
+ * @param firstUp       The fewest minutes past a step the policy rounds up.
+ */
+static PUNCHCARD_ALWAYS_INLINE void processRoundedBatchLine(
+        const char *line, const char *end, struct OutputBuffer *output,
+        RoundingFunction roundInterval, int step, int firstUp) {
+    /**
+     * The total minutes worked this day.
+     */
+    int totalMinutes = 0;
+
+    /**
+     * The total of each interval worked this day, rounded on its own.
+     */
+    int roundedMinutes = 0;
+
+    /**
+     * The number of intervals on the line.
+     */
+    int count = -1;
+
+    // Sum the line, rounding each interval if asked to.
+    output->counters->lines++;
+    if (line != NULL) {
+        count = output->rounding.perInterval ?
+                sumRoundedTimesInLine(line, end, roundInterval, &totalMinutes,
+                                      &roundedMinutes) :
+                sumTimesInLine(line, end, &totalMinutes);
+    }
+
+    // If something was wrong with the line, save what can be saved of it if
+    // asked to, or say so and move on.
+    if (count == -1 && line != NULL && output->recover) {
+        processRecoveredBatchLine(line, end, 0, output);
+        return;
+    }
+    if (count == -1) {
+        countUnreadableLine(output->counters, line, end);
+        outputText(output, "ERROR\n", 6);
+        return;
+    }
+    output->counters->intervals += (uint64_t) count;
+    if (!output->rounding.perInterval) {
+        roundedMinutes = roundToStep(totalMinutes, step, firstUp);
+    }
+    outputRoundedDayResult(output, totalMinutes, roundedMinutes);
+}
+
+/**
+ * Processes a single line of batch input like processRoundedBatchLine(), but
+ * counts time covered by more than one interval only once.
+ *
+ * @param line    A pointer to the first character of the line, or NULL if the
+ *                line was too long to read.
+ * @param end     A pointer one past the last character of the line, not
+ *                including the newline.
+ * @param output  The output buffer to write the result line to.
+ * @param step    The step the rounding policy rounds to a multiple of.
+ * @param firstUp The fewest minutes past a step the policy rounds up.
+ */
+static PUNCHCARD_ALWAYS_INLINE void processRoundedMergedBatchLine(
+        const char *line, const char *end, struct OutputBuffer *output,
+        int step, int firstUp) {
+    /**
+     * The merged totals for this day.
+     */
+    struct MergedDay day;
+
+    /**
+     * The number of intervals on the line.
+     */
+    int count = line == NULL ? -1 : mergeTimesInLine(line, end, &day);
+
+    // Too many intervals to merge is as much an error as an unreadable time.
+    output->counters->lines++;
+    if (count == -1 && line != NULL && output->recover) {
+        processRecoveredBatchLine(line, end, 1, output);
+        return;
+    }
+    if (count == -1) {
+        countUnreadableLine(output->counters, line, end);
+        outputText(output, "ERROR\n", 6);
+        return;
+    }
+    output->counters->intervals += (uint64_t) count;
+    outputMergedDayResult(output, &day,
+                          roundToStep(day.minutes, step, firstUp));
+}
+
+/**
+ * Defines the line handlers for a rounding policy, processBatchLine and
+ * processMergedBatchLine followed by the policy's name, each a copy of the
+ * functions above with the policy's rounding inlined.
+ */
+#define BATCH_LINE_HANDLERS(name, policy, step, firstUp) \
+    void processBatchLine##name(const char *line, const char *end, \
+                                struct OutputBuffer *output) { \
+        processRoundedBatchLine(line, end, output, round##name, step, \
+                                firstUp); \
+    } \
+    void processMergedBatchLine##name(const char *line, const char *end, \
+                                      struct OutputBuffer *output) { \
+        processRoundedMergedBatchLine(line, end, output, step, firstUp); \
+    }
+ROUNDING_POLICIES(BATCH_LINE_HANDLERS)
+#undef BATCH_LINE_HANDLERS
+
+/**
+ * Finds the line handler for batch input rounded by a policy, so the policy is
+ * looked up once for the whole input rather than for every line.
+ *
+ * @param rounding      How the totals are rounded.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ *
+ * @return The line handler.
+ */
+LineHandler findBatchLineHandler(const struct Rounding *rounding,
+                                 int mergeOverlaps) {
+    switch (rounding->policy) {
+#define BATCH_LINE_HANDLER(name, policy, step, firstUp) \
+        case policy: \
+            return mergeOverlaps ? processMergedBatchLine##name : \
+                                   processBatchLine##name;
+        ROUNDING_POLICIES(BATCH_LINE_HANDLER)
+#undef BATCH_LINE_HANDLER
+    }
+    return mergeOverlaps ? processMergedBatchLineQuarterHour :
+                           processBatchLineQuarterHour;
+}
+
+/**
+ * Adds a 16-bit number to an output buffer as two bytes, least significant
+ * first.
+ *
+ * @param output The output buffer to add to.
+ * @param value  The number to add.
+ */
+void outputUint16(struct OutputBuffer *output, uint16_t value) {
+    outputChar(output, (char) (value & 0xFF));
+    outputChar(output, (char) (value >> 8));
+}
+
+/**
+ * Adds a 32-bit number to an output buffer as four bytes, least significant
+ * first.
+ *
+ * @param output The output buffer to add to.
+ * @param value  The number to add.
+ */
+void outputUint32(struct OutputBuffer *output, uint32_t value) {
+    outputUint16(output, (uint16_t) (value & 0xFFFF));
+    outputUint16(output, (uint16_t) (value >> 16));
+}
+
+/**
+ * Adds a 64-bit number to an output buffer as eight bytes, least significant
+ * first.
+ *
+ * @param output The output buffer to add to.
+ * @param value  The number to add.
+ */
+void outputUint64(struct OutputBuffer *output, uint64_t value) {
+    outputUint32(output, (uint32_t) (value & 0xFFFFFFFF));
+    outputUint32(output, (uint32_t) (value >> 32));
+}
+
+/**
+ * Converts a single line of batch input to a binary punch record: the number
+ * of intervals as a 16-bit count, followed by the start and end of each as
+ * 16-bit minutes since midnight, all least significant byte first. A line that
+ * could not be read is recorded with a count of BINARY_ERROR_COUNT and no
+ * intervals.
+ *
+ * @param line   A pointer to the first character of the line, or NULL if the
+ *               line was too long to read.
+ * @param end    A pointer one past the last character of the line, not
+ *               including the newline.
+ * @param output The output buffer to write the record to.
+ */
+void convertBatchLine(const char *line, const char *end,
+                      struct OutputBuffer *output) {
+    /**
+     * The start and end of each interval on the line.
+     */
+    static thread_local uint16_t intervals[BINARY_MAX_INTERVALS][2];
+
+    /**
+     * The number of intervals on the line.
+     */
+    int count = line == NULL ? -1 : collectIntervalsInLine(
+            line, end, intervals, BINARY_MAX_INTERVALS);
+
+    // If something was wrong with the line, record that and move on.
+    output->counters->lines++;
+    if (count == -1) {
+        countUnreadableLine(output->counters, line, end);
+        outputUint16(output, BINARY_ERROR_COUNT);
+        return;
+    }
+    output->counters->intervals += (uint64_t) count;
+
+    // Otherwise, record every interval.
+    outputReserve(output, 2 + (size_t) count * 4);
+    outputUint16(output, (uint16_t) count);
+    for (int i = 0; i < count; i++) {
+        outputUint16(output, intervals[i][0]);
+        outputUint16(output, intervals[i][1]);
+    }
+}
+
+/**
+ * Takes a task from the bottom of a worker's own deque. Only the worker owning
+ * the deque takes from the bottom, so the only race is with another worker
+ * taking the last task from the top at the same moment, which is settled by
+ * whoever moves the top first.
+ *
+ * @param chunk The worker taking a task.
+ *
+ * @return The index of the task taken, or -1 if the deque is empty.
+ */
+int takeBatchTask(struct BatchChunk *chunk) {
+    /**
+     * The task at the bottom of the deque, claimed before checking the top.
+     */
+    int bottom = atomic_load_explicit(&chunk->bottom,
+                                      memory_order_relaxed) - 1;
+
+    /**
+     * The first task not yet taken from the top.
+     */
+    int top;
+
+    /**
+     * The task taken.
+     */
+    int task = bottom;
+
+    atomic_store_explicit(&chunk->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    top = atomic_load_explicit(&chunk->top, memory_order_relaxed);
+    if (top < bottom) {
+        return task;
+    }
+
+    // The last task goes to whoever moves the top past it first.
+    if (top > bottom ||
+        !atomic_compare_exchange_strong_explicit(&chunk->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        task = -1;
+    }
+    atomic_store_explicit(&chunk->bottom, bottom + 1, memory_order_relaxed);
+    return task;
+}
+
+/**
+ * Takes a task from the top of another worker's deque.
+ *
+ * @param victim The worker to take a task from.
+ *
+ * @return The index of the task taken, -1 if the deque is empty, or -2 if
+ *         another worker took the task first, so it's worth trying again.
+ */
+int stealBatchTask(struct BatchChunk *victim) {
+    /**
+     * The first task not yet taken from the top.
+     */
+    int top = atomic_load_explicit(&victim->top, memory_order_acquire);
+
+    /**
+     * One past the last task not yet taken from the bottom.
+     */
+    int bottom;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    bottom = atomic_load_explicit(&victim->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return -1;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&victim->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return -2;
+    }
+    return top;
+}
+
+/**
+ * Processes every line of a task into the task's own output buffer, then
+ * publishes the results for the writer. A task that fails is published all the
+ * same, so the writer never waits on it.
+ *
+ * @param worker The worker processing the task.
+ * @param task   The task to process.
+ *
+ * @return 0 if every line was processed, -1 if the output buffer could not
+ *         grow to hold the results.
+ */
+int processBatchTask(const struct BatchChunk *worker, struct BatchTask *task) {
+    /**
+     * The start of the next line in the task.
+     */
+    const char *cursor = task->begin;
+
+    task->output.length = 0;
+    task->failed        = 0;
+    task->counters      = (struct Counters) {0};
+
+    // Process every line, each of which ends with a newline.
+    while (cursor < task->end) {
+        /**
+         * The newline ending the current line.
+         */
+        const char *newline = memchr(cursor, '\n', task->end - cursor);
+
+        // Make sure there's room for another result.
+        if (outputReserve(&task->output, BATCH_RESULT_SIZE) == -1) {
+            task->failed = 1;
+            break;
+        }
+
+        // A line too long for a block is an error however it was read.
+        if (newline - cursor < BATCH_BLOCK_SIZE) {
+            worker->handler(cursor, newline, &task->output);
+        } else {
+            worker->handler(NULL, NULL, &task->output);
+        }
+        cursor = newline + 1;
+    }
+
+    // Release the results along with the sequence number.
+    atomic_store_explicit(&task->published, task->sequence,
+                          memory_order_release);
+    return task->failed ? -1 : 0;
+}
+
+/**
+ * Writes out the results of every task that has been published, in input
+ * order, stopping at the first task still being processed. Only one thread
+ * ever writes out a block.
+ *
+ * @param output The output buffer to write the results to.
+ * @param chunks The workers the block was split between.
+ * @param next   The index of the next task to write out, moved past every task
+ *               written.
+ * @param count  The number of tasks in the block.
+ *
+ * @return 0 if every task written out succeeded, -1 if any failed.
+ */
+int writeBatchTasks(struct OutputBuffer *output, struct BatchChunk *chunks,
+                    int *next, int count) {
+    /**
+     * Whether every task written out succeeded.
+     */
+    int succeeded = 1;
+
+    for (; *next < count; ++*next) {
+        /**
+         * The task whose results are next.
+         */
+        struct BatchTask *task =
+                &chunks[*next / BATCH_TASKS_PER_THREAD]
+                        .tasks[*next % BATCH_TASKS_PER_THREAD];
+
+        if (atomic_load_explicit(&task->published, memory_order_acquire) !=
+            task->sequence) {
+            break;
+        }
+        succeeded &= !task->failed;
+        outputText(output, task->output.data, task->output.length);
+        addCounters(output->counters, &task->counters);
+    }
+    return succeeded ? 0 : -1;
+}
+
+/**
+ * Processes every task in a worker's deque, and then every task it can take
+ * from the other workers' deques. The worker writing out the block also writes
+ * out whatever results are ready after each task it finishes, so output keeps
+ * pace with the workers rather than waiting for the whole block.
+ *
+ * @param chunk  The worker processing tasks.
+ * @param output The output buffer to write the results to, or NULL for a
+ *               worker that doesn't write out the block.
+ * @param next   The index of the next task to write out, if writing.
+ *
+ * @return 0 if every task processed and written succeeded, -1 otherwise.
+ */
+int workBatchChunk(struct BatchChunk *chunk, struct OutputBuffer *output,
+                   int *next) {
+    /**
+     * The number of tasks in the block.
+     */
+    int taskCount = chunk->workerCount * BATCH_TASKS_PER_THREAD;
+
+    /**
+     * Whether every task succeeded.
+     */
+    int succeeded = 1;
+
+    /**
+     * The index of the task being processed.
+     */
+    int task;
+
+    // Work through this worker's own tasks first.
+    while ((task = takeBatchTask(chunk)) != -1) {
+        succeeded &= processBatchTask(chunk, &chunk->tasks[task]) == 0;
+        if (output != NULL) {
+            succeeded &= writeBatchTasks(output, chunk->workers, next,
+                                         taskCount) == 0;
+        }
+    }
+
+    // Then take tasks from each other worker in turn until none are left.
+    // Nothing is ever added to a deque once the workers start, so a deque
+    // found empty stays empty.
+    for (int other = 1; other < chunk->workerCount;) {
+        /**
+         * The worker to take tasks from.
+         */
+        struct BatchChunk *victim =
+                &chunk->workers[(chunk - chunk->workers + other) %
+                                chunk->workerCount];
+
+        task = stealBatchTask(victim);
+        if (task == -1) {
+            other++;
+        } else if (task >= 0) {
+            succeeded &= processBatchTask(chunk, &victim->tasks[task]) == 0;
+            if (output != NULL) {
+                succeeded &= writeBatchTasks(output, chunk->workers, next,
+                                             taskCount) == 0;
+            }
+        }
+    }
+
+    // Every task has been taken, so the rest only need to be waited for.
+    if (output != NULL) {
+        succeeded &= writeBatchTasks(output, chunk->workers, next,
+                                     taskCount) == 0;
+        while (*next < taskCount) {
+            thrd_yield();
+            succeeded &= writeBatchTasks(output, chunk->workers, next,
+                                         taskCount) == 0;
+        }
+    }
+    return succeeded ? 0 : -1;
+}
+
+/**
+ * Processes tasks as a worker that doesn't write out the block. Used as the
+ * body of each worker thread.
+ *
+ * @param argument A pointer to the struct BatchChunk of the worker.
+ *
+ * @return thrd_success if every task taken was processed, thrd_nomem if an
+ *         output buffer could not grow to hold the results.
+ */
+int processBatchChunk(void *argument) {
+    return workBatchChunk(argument, NULL, NULL) == 0 ? thrd_success :
+                                                       thrd_nomem;
+}
+
+/**
+ * Splits the complete lines in a block of batch input into tasks at newline
+ * boundaries, dealing an even share of them to each worker, processes the
+ * tasks, and writes their results out in input order as they are published.
+ *
+ * @param output      The output buffer to write the results to.
+ * @param chunks      The workers to split the block between.
+ * @param threadCount The number of workers to split the block between.
+ * @param begin       A pointer to the first character of the block.
+ * @param end         A pointer one past the last newline of the block.
+ *
+ * @return 0 if the whole block was processed, -1 if a worker failed.
+ */
+int processBatchBlock(struct OutputBuffer *output, struct BatchChunk *chunks,
+                      int threadCount, const char *begin, const char *end) {
+    /**
+     * The workers processing each chunk but the first, which this thread
+     * processes itself.
+     */
+    thrd_t threads[BATCH_MAX_THREADS];
+
+    /**
+     * The number of workers started.
+     */
+    int started = 0;
+
+    /**
+     * Whether every chunk was processed successfully.
+     */
+    int succeeded = 1;
+
+    /**
+     * The number of tasks the block is split into.
+     */
+    int taskCount = threadCount * BATCH_TASKS_PER_THREAD;
+
+    /**
+     * The index of the next task to write out.
+     */
+    int next = 0;
+
+    /**
+     * Where the previous task ended.
+     */
+    const char *previous = begin;
+
+    // Split the block into roughly equal tasks ending at a newline.
+    for (int i = 0; i < taskCount; i++) {
+        /**
+         * The task being set up.
+         */
+        struct BatchTask *task = &chunks[i / BATCH_TASKS_PER_THREAD]
+                                          .tasks[i % BATCH_TASKS_PER_THREAD];
+
+        /**
+         * Where this task would end if split evenly.
+         */
+        const char *split = begin + (end - begin) * (i + 1) / taskCount;
+
+        task->begin     = previous;
+        task->end       = split <= previous ? previous :
+                          (const char *) memchr(split - 1, '\n',
+                                                end - (split - 1)) + 1;
+        task->sequence += taskCount;
+        previous        = task->end;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        chunks[i].workers     = chunks;
+        chunks[i].workerCount = threadCount;
+        atomic_store_explicit(&chunks[i].top, 0, memory_order_relaxed);
+        atomic_store_explicit(&chunks[i].bottom, BATCH_TASKS_PER_THREAD,
+                              memory_order_relaxed);
+    }
+
+    // Hand every chunk but the first to a worker, and process the first here,
+    // writing out the results as they come. A worker that couldn't start
+    // simply has its tasks taken by the others.
+    for (int i = 1; i < threadCount; i++) {
+        if (thrd_create(&threads[started], processBatchChunk, &chunks[i]) ==
+            thrd_success) {
+            started++;
+        }
+    }
+    succeeded &= workBatchChunk(&chunks[0], output, &next) == 0;
+    for (int i = 0; i < started; i++) {
+        /**
+         * What the worker returned.
+         */
+        int workerResult;
+
+        thrd_join(threads[i], &workerResult);
+        succeeded &= workerResult == thrd_success;
+    }
+    return succeeded ? 0 : -1;
+}
+
+/**
+ * Frees the output buffers of the tasks of the chunks each block of batch input
+ * was split between.
+ *
+ * @param chunks    The chunks to free.
+ * @param taskCount The number of tasks to free, counting from the first task of
+ *                  the first chunk.
+ */
+void closeBatchTasks(struct BatchChunk *chunks, int taskCount) {
+    for (int i = 0; i < taskCount; i++) {
+        free(chunks[i / BATCH_TASKS_PER_THREAD]
+                     .tasks[i % BATCH_TASKS_PER_THREAD].output.data);
+    }
+}
+
+/**
+ * Frees the output buffers of the chunks each block of batch input was split
+ * between.
+ *
+ * @param chunks      The chunks to free.
+ * @param threadCount The number of chunks to free.
+ */
+void closeBatchChunks(struct BatchChunk *chunks, int threadCount) {
+    closeBatchTasks(chunks, threadCount * BATCH_TASKS_PER_THREAD);
+}
+
+/**
+ * Sets up the chunks each block of batch input is split between, with an
+ * output buffer for each of their tasks.
+ *
+ * @param chunks      The chunks to set up.
+ * @param threadCount The number of chunks to set up.
+ * @param handler     The function processing each line.
+ * @param output      The output buffer the chunks' results will be copied to,
+ *                    whose rounding and recovery they share.
+ *
+ * @return 0 if the chunks were set up, -1 if there wasn't enough memory.
+ */
+int openBatchChunks(struct BatchChunk *chunks, int threadCount,
+                    LineHandler handler, const struct OutputBuffer *output) {
+    for (int i = 0; i < threadCount * BATCH_TASKS_PER_THREAD; i++) {
+        /**
+         * The task being set up.
+         */
+        struct BatchTask *task = &chunks[i / BATCH_TASKS_PER_THREAD]
+                                          .tasks[i % BATCH_TASKS_PER_THREAD];
+
+        chunks[i / BATCH_TASKS_PER_THREAD].handler = handler;
+        if (outputOpen(&task->output, NULL,
+                       OUTPUT_BUFFER_SIZE / BATCH_TASKS_PER_THREAD) == -1) {
+            closeBatchTasks(chunks, i);
+            return -1;
+        }
+        task->output.rounding = output->rounding;
+        task->output.counters = &task->counters;
+        task->output.recover  = output->recover;
+
+        // Start each slot as if its task from the block before was written.
+        task->sequence = (size_t) i;
+        atomic_init(&task->published, task->sequence);
+    }
+    return 0;
+}
+
+/**
+ * Reads from a file until a buffer is full or the file runs out, since a single
+ * read may return less than was asked for.
+ *
+ * @param input  The file to read from.
+ * @param buffer The buffer to read into.
+ * @param size   The number of bytes to read.
+ *
+ * @return The number of bytes read, less than asked for only at the end of the
+ *         file.
+ */
+size_t readBlock(struct IoFile *input, char *buffer, size_t size) {
+    /**
+     * The number of bytes read so far.
+     */
+    size_t total = 0;
+
+    /**
+     * When the first read started.
+     */
+    uint64_t started = readClock();
+
+    while (total < size) {
+        /**
+         * The number of bytes read this time around.
+         */
+        size_t bytesRead = ioRead(input, buffer + total, size - total);
+
+        if (bytesRead == 0) {
+            break;
+        }
+        total += bytesRead;
+    }
+    statistics.inputNanoseconds += readClock() - started;
+    statistics.bytesRead        += total;
+    writeRequestedStatistics();
+    return total;
+}
+
+/**
+ * Runs PUNCHCARD non-interactively over a file with one day of times per line,
+ * writing one result per input line. The file is read in large blocks rather
+ * than a character at a time, and each block is split between worker threads
+ * that process their share of the lines in place.
+ *
+ * @param input       The file to read times from.
+ * @param start       The bytes already read from the start of the file, which
+ *                    come before the rest of it.
+ * @param startSize   The number of bytes already read, less than
+ *                    BATCH_BLOCK_SIZE.
+ * @param threadCount The number of threads to process the file with, from 1 to
+ *                    BATCH_MAX_THREADS.
+ * @param handler     The function processing each line.
+ * @param output      The output buffer to write the results to.
+ *
+ * @return 0 if the whole file was processed, 1 if it could not be.
+ */
+int runBatch(struct IoFile *input, const char *start, size_t startSize,
+             int threadCount, LineHandler handler,
+             struct OutputBuffer *output) {
+    /**
+     * The size of the block of input read at once.
+     */
+    size_t blockSize = (size_t) BATCH_BLOCK_SIZE * threadCount;
+
+    /**
+     * The block of input currently being processed.
+     */
+    char *buffer;
+
+    /**
+     * The share of each block given to each worker.
+     */
+    struct BatchChunk chunks[BATCH_MAX_THREADS] = {0};
+
+    /**
+     * The number of bytes at the start of the buffer holding an incomplete
+     * line carried over from the previous block.
+     */
+    size_t carried = startSize;
+
+    /**
+     * Whether the rest of the current line is being thrown away because it
+     * was too long to fit in the buffer.
+     */
+    int discarding = 0;
+
+    /**
+     * The value to exit with.
+     */
+    int status = 0;
+
+    // Set aside room for a block of the file and each worker's results.
+    buffer = malloc(blockSize + 1);
+    if (buffer == NULL ||
+        openBatchChunks(chunks, threadCount, handler, output) == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        free(buffer);
+        return 1;
+    }
+
+    // Start with whatever was already read, as if carried over.
+    memcpy(buffer, start, startSize);
+
+    // Until the whole file has been read...
+    while (1) {
+        /**
+         * The number of new bytes read into the buffer.
+         */
+        size_t bytesRead = readBlock(input, buffer + carried,
+                                     blockSize - carried);
+
+        /**
+         * One past the last byte available in the buffer.
+         */
+        char *end = buffer + carried + bytesRead;
+
+        /**
+         * One past the last complete line in the buffer.
+         */
+        char *linesEnd = end;
+
+        // If there's nothing left, finish off a last line with no newline.
+        if (bytesRead == 0) {
+            if (carried > 0 && !discarding) {
+                *end++ = '\n';
+                if (processBatchBlock(output, chunks, 1, buffer, end) == -1) {
+                    status = 1;
+                }
+            }
+            break;
+        }
+
+        // Find the end of the last complete line.
+        while (linesEnd > buffer && linesEnd[-1] != '\n') {
+            linesEnd--;
+        }
+
+        // Drop the rest of a line that was too long to fit.
+        if (discarding && linesEnd > buffer) {
+            /**
+             * The newline ending the line being thrown away.
+             */
+            char *newline = memchr(buffer, '\n', linesEnd - buffer);
+
+            memmove(buffer, newline + 1, end - (newline + 1));
+            linesEnd -= newline + 1 - buffer;
+            end -= newline + 1 - buffer;
+            discarding = 0;
+        }
+
+        // Process every complete line in the buffer.
+        if (processBatchBlock(output, chunks, threadCount, buffer,
+                              linesEnd) == -1) {
+            printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+            status = 1;
+            break;
+        }
+
+        // Keep the incomplete line for the next block, unless it can't fit.
+        carried = end - linesEnd;
+        if (carried == blockSize) {
+            if (!discarding) {
+                handler(NULL, NULL, output);
+            }
+            discarding = 1;
+            carried    = 0;
+        } else {
+            memmove(buffer, linesEnd, carried);
+        }
+    }
+
+    // Clean up.
+    closeBatchChunks(chunks, threadCount);
+    free(buffer);
+    return status;
+}
+
+/**
+ * Maps a whole file into memory, read-only, so it can be parsed in place
+ * without copying it into a buffer first. The operating system is told the file
+ * will be read from start to end, so it can read ahead.
+ *
+ * @param path    The path of the file to map.
+ * @param mapping The mapping to set up.
+ *
+ * @return 0 if the file was mapped, -1 if it could not be, in which case it
+ *         should be read the ordinary way instead.
+ */
+int mapInputFile(const char *path, struct InputMapping *mapping) {
+    mapping->data = NULL;
+    mapping->size = 0;
+#if defined(PUNCHCARD_MMAP_POSIX)
+    /**
+     * The file being mapped.
+     */
+    int file = open(path, O_RDONLY);
+
+    /**
+     * Information about the file, including its size.
+     */
+    struct stat status;
+
+    /**
+     * Where the file was mapped to.
+     */
+    void *data;
+
+    if (file == -1) {
+        return -1;
+    }
+    if (fstat(file, &status) == -1 || !S_ISREG(status.st_mode)) {
+        close(file);
+        return -1;
+    }
+
+    // An empty file has nothing to map.
+    if (status.st_size == 0) {
+        close(file);
+        return 0;
+    }
+    data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file,
+                0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return -1;
+    }
+    madvise(data, (size_t) status.st_size, MADV_SEQUENTIAL);
+    mapping->data = data;
+    mapping->size = (size_t) status.st_size;
+    return 0;
+#elif defined(PUNCHCARD_MMAP_WINDOWS)
+    /**
+     * The file being mapped.
+     */
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+    /**
+     * The size of the file.
+     */
+    LARGE_INTEGER size;
+
+    /**
+     * The mapping object backing the view of the file.
+     */
+    HANDLE view;
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return -1;
+    }
+    if (!GetFileSizeEx(file, &size) || (uint64_t) size.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return -1;
+    }
+
+    // An empty file has nothing to map.
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return 0;
+    }
+    view = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (view == NULL) {
+        return -1;
+    }
+    mapping->data = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(view);
+    if (mapping->data == NULL) {
+        return -1;
+    }
+    mapping->size = (size_t) size.QuadPart;
+    return 0;
+#else
+    (void) path;
+    return -1;
+#endif
+}
+
+/**
+ * Tells the operating system part of a mapped file has been processed and
+ * won't be read again, so the memory holding it can be given back. This keeps
+ * memory use flat no matter how big the file is. The part counts as read for
+ * the statistics.
+ *
+ * @param mapping The mapping the part belongs to.
+ * @param from    The offset of the first byte processed.
+ * @param to      The offset one past the last byte processed.
+ */
+void releaseMappedRange(const struct InputMapping *mapping, size_t from,
+                        size_t to) {
+    // Count the part as read, before it is trimmed to whole pages.
+    statistics.bytesRead += to - from;
+    writeRequestedStatistics();
+
+#if defined(PUNCHCARD_MMAP_POSIX)
+    /**
+     * The size of a page of memory, which the range must be aligned to.
+     */
+    size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+
+    // Only whole pages can be released, so leave any partial ones be.
+    from = (from + pageSize - 1) / pageSize * pageSize;
+    to   = to / pageSize * pageSize;
+    if (from < to) {
+        madvise((char *) mapping->data + from, to - from, MADV_DONTNEED);
+    }
+#else
+    (void) mapping;
+#endif
+}
+
+/**
+ * Unmaps a file mapped by mapInputFile().
+ *
+ * @param mapping The mapping to remove.
+ */
+void unmapInputFile(struct InputMapping *mapping) {
+    if (mapping->data == NULL) {
+        return;
+    }
+#if defined(PUNCHCARD_MMAP_POSIX)
+    munmap((void *) mapping->data, mapping->size);
+#elif defined(PUNCHCARD_MMAP_WINDOWS)
+    UnmapViewOfFile(mapping->data);
+#endif
+    mapping->data = NULL;
+    mapping->size = 0;
+}
+
+/**
+ * Runs PUNCHCARD non-interactively over a file mapped into memory with one day
+ * of times per line, writing one result per input line. Lines are parsed
+ * straight out of the mapping with no copying, but a line of BATCH_BLOCK_SIZE
+ * bytes or more is still reported as an error, as it is when read in blocks.
+ *
+ * @param mapping     The mapped file to read times from.
+ * @param offset      The offset in the mapping of the first line.
+ * @param threadCount The number of threads to process the file with, from 1 to
+ *                    BATCH_MAX_THREADS.
+ * @param handler     The function processing each line.
+ * @param output      The output buffer to write the results to.
+ *
+ * @return 0 if the whole file was processed, 1 if it could not be.
+ */
+int runMappedBatch(const struct InputMapping *mapping, size_t offset,
+                   int threadCount, LineHandler handler,
+                   struct OutputBuffer *output) {
+    /**
+     * The size of the piece of the file processed at once.
+     */
+    size_t blockSize = (size_t) BATCH_BLOCK_SIZE * threadCount;
+
+    /**
+     * The share of each piece given to each worker.
+     */
+    struct BatchChunk chunks[BATCH_MAX_THREADS] = {0};
+
+    /**
+     * The start of the next line to process.
+     */
+    const char *cursor = mapping->data + offset;
+
+    /**
+     * One past the last byte of the file.
+     */
+    const char *end = mapping->data + mapping->size;
+
+    if (openBatchChunks(chunks, threadCount, handler, output) == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        return 1;
+    }
+
+    // Until the whole file has been processed...
+    while (cursor < end) {
+        /**
+         * Where this piece would end if it were exactly a block long.
+         */
+        const char *blockEnd = (size_t) (end - cursor) > blockSize ?
+                               cursor + blockSize : end;
+
+        /**
+         * One past the last complete line in the piece.
+         */
+        const char *linesEnd = blockEnd;
+
+        // End the piece after its last newline, or the first one after it if
+        // a single line is longer than a block.
+        while (linesEnd > cursor && linesEnd[-1] != '\n') {
+            linesEnd--;
+        }
+        if (linesEnd == cursor) {
+            linesEnd = memchr(blockEnd, '\n', end - blockEnd);
+            linesEnd = linesEnd == NULL ? NULL : linesEnd + 1;
+        }
+
+        // Finish off a last line with no newline on its own, unless it is too
+        // long, the same as if it had been read in blocks.
+        if (linesEnd == NULL) {
+            if (end - cursor < BATCH_BLOCK_SIZE) {
+                handler(cursor, end, output);
+            } else {
+                handler(NULL, NULL, output);
+            }
+            break;
+        }
+
+        if (processBatchBlock(output, chunks, threadCount, cursor,
+                              linesEnd) == -1) {
+            printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+            closeBatchChunks(chunks, threadCount);
+            return 1;
+        }
+        releaseMappedRange(mapping, cursor - mapping->data,
+                           linesEnd - mapping->data);
+        cursor = linesEnd;
+    }
+
+    closeBatchChunks(chunks, threadCount);
+    return 0;
+}
+
+/**
+ * Reads a 16-bit number stored as two bytes, least significant first.
+ *
+ * @param bytes A pointer to the first of the two bytes.
+ *
+ * @return The number read.
+ */
+uint16_t readUint16(const char *bytes) {
+    return (uint16_t) ((unsigned char) bytes[0] |
+                       (unsigned char) bytes[1] << 8);
+}
+
+/**
+ * Reads a 32-bit number stored as four bytes, least significant first.
+ *
+ * @param bytes A pointer to the first of the four bytes.
+ *
+ * @return The number read.
+ */
+uint32_t readUint32(const char *bytes) {
+    return readUint16(bytes) | (uint32_t) readUint16(bytes + 2) << 16;
+}
+
+/**
+ * Reads a 64-bit number stored as eight bytes, least significant first.
+ *
+ * @param bytes A pointer to the first of the eight bytes.
+ *
+ * @return The number read.
+ */
+uint64_t readUint64(const char *bytes) {
+    return readUint32(bytes) | (uint64_t) readUint32(bytes + 4) << 32;
+}
+
+/**
+ * Checks that every start and end time in a binary punch record is a minute of
+ * the day, as every time read from text is.
+ *
+ * @param intervals A pointer to the first interval of the record.
+ * @param count     The number of intervals in the record.
+ *
+ * @return 1 if every time is less than MINUTES_PER_DAY, 0 otherwise.
+ */
+int binaryRecordInRange(const char *intervals, int count) {
+    /**
+     * Whether any time in the record is out of range.
+     */
+    int outOfRange = 0;
+
+    for (int i = 0; i < count * 2; i++) {
+        outOfRange |= readUint16(intervals + i * 2) >= MINUTES_PER_DAY;
+    }
+    return !outOfRange;
+}
+
+/**
+ * Writes the same result line for each day in a run of binary punch records as
+ * batch mode writes for a line of times, straight from the stored intervals
+ * with no parsing needed. Inlined into processBinaryRecords() once for each
+ * rounding policy, with the policy's step and threshold as constants.
+ *
+ * @param begin         A pointer to the first record.
+ * @param end           A pointer one past the last byte available.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ * @param output        The output buffer to write the results to.
+ * @param step          The step the rounding policy rounds to a multiple of.
+ * @param firstUp       The fewest minutes past a step the policy rounds up.
+ *
+ * @return A pointer to the first record not processed because it was cut off
+ *         by the end of the bytes available.
+ */
+static PUNCHCARD_ALWAYS_INLINE const char *processRoundedBinaryRecords(
+        const char *begin, const char *end, int mergeOverlaps,
+        struct OutputBuffer *output, int step, int firstUp) {
+    /**
+     * The start of the next record.
+     */
+    const char *cursor = begin;
+
+    // Process every complete record.
+    while (end - cursor >= 2) {
+        /**
+         * The number of intervals in the record.
+         */
+        uint16_t count = readUint16(cursor);
+
+        /**
+         * The total minutes worked this day.
+         */
+        int totalMinutes = 0;
+
+        /**
+         * The total of each interval worked this day, rounded on its own.
+         */
+        int roundedMinutes = 0;
+
+        if (count == BINARY_ERROR_COUNT) {
+            output->counters->lines++;
+            output->counters->errorLines++;
+            outputText(output, "ERROR\n", 6);
+            cursor += 2;
+            continue;
+        }
+        if (end - cursor < 2 + (ptrdiff_t) count * 4) {
+            break;
+        }
+        output->counters->lines++;
+
+        // A time no line of text could hold means the file was damaged.
+        if (!binaryRecordInRange(cursor + 2, count)) {
+            output->counters->errorLines++;
+            outputText(output, "ERROR\n", 6);
+            cursor += 2 + (ptrdiff_t) count * 4;
+            continue;
+        }
+
+        // Merge the intervals if asked to, as long as there's room for them.
+        if (mergeOverlaps) {
+            /**
+             * The start and end of each interval in the record.
+             */
+            uint16_t intervals[MERGE_MAX_INTERVALS][2];
+
+            /**
+             * The merged totals for this day.
+             */
+            struct MergedDay day;
+
+            if (count > MERGE_MAX_INTERVALS) {
+                output->counters->errorLines++;
+                output->counters->errors[LINE_TOO_MANY_INTERVALS]++;
+                outputText(output, "ERROR\n", 6);
+            } else {
+                output->counters->intervals += count;
+                for (int i = 0; i < count; i++) {
+                    intervals[i][0] = readUint16(cursor + 2 + i * 4);
+                    intervals[i][1] = readUint16(cursor + 4 + i * 4);
+                }
+                mergeIntervals(intervals, count, &day);
+                outputMergedDayResult(output, &day,
+                                      roundToStep(day.minutes, step, firstUp));
+            }
+            cursor += 2 + (ptrdiff_t) count * 4;
+            continue;
+        }
+
+        // Sum the intervals the same way as if they'd been read as text.
+        output->counters->intervals += count;
+        if (output->rounding.perInterval) {
+            for (const char *interval = cursor + 2;
+                 interval < cursor + 2 + (ptrdiff_t) count * 4;
+                 interval += 4) {
+                /**
+                 * The minutes worked in this interval.
+                 */
+                int worked = difference(readUint16(interval),
+                                        readUint16(interval + 2));
+
+                totalMinutes   += worked;
+                roundedMinutes += roundToStep(worked, step, firstUp);
+            }
+            outputRoundedDayResult(output, totalMinutes, roundedMinutes);
+            cursor += 2 + (ptrdiff_t) count * 4;
+            continue;
+        }
+        for (const char *interval = cursor + 2;
+             interval < cursor + 2 + (ptrdiff_t) count * 4; interval += 4) {
+            totalMinutes += difference(readUint16(interval),
+                                       readUint16(interval + 2));
+        }
+        outputRoundedDayResult(output, totalMinutes,
+                               roundToStep(totalMinutes, step, firstUp));
+        cursor += 2 + (ptrdiff_t) count * 4;
+    }
+    return cursor;
+}
+
+/**
+ * Writes the same result line for each day in a run of binary punch records as
+ * batch mode writes for a line of times, picking the rounding policy once for
+ * the whole run.
+ *
+ * @param begin         A pointer to the first record.
+ * @param end           A pointer one past the last byte available.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ * @param output        The output buffer to write the results to.
+ *
+ * @return A pointer to the first record not processed because it was cut off
+ *         by the end of the bytes available.
+ */
+const char *processBinaryRecords(const char *begin, const char *end,
+                                 int mergeOverlaps,
+                                 struct OutputBuffer *output) {
+    switch (output->rounding.policy) {
+#define PROCESS_BINARY_RECORDS(name, policy, step, firstUp) \
+        case policy: \
+            return processRoundedBinaryRecords(begin, end, mergeOverlaps, \
+                                               output, step, firstUp);
+        ROUNDING_POLICIES(PROCESS_BINARY_RECORDS)
+#undef PROCESS_BINARY_RECORDS
+    }
+    return begin;
+}
+
+/**
+ * Runs PUNCHCARD non-interactively over a binary punch file, writing the same
+ * result line for each day batch mode writes for a line of times.
+ *
+ * @param input         The binary punch file to read, just past its header.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ * @param output        The output buffer to write the results to.
+ *
+ * @return 0 if the whole file was processed, 1 if it could not be.
+ */
+int runBinaryBatch(struct IoFile *input, int mergeOverlaps,
+                   struct OutputBuffer *output) {
+    /**
+     * The block of input currently being processed.
+     */
+    char *buffer = malloc(BATCH_BLOCK_SIZE);
+
+    /**
+     * The number of bytes at the start of the buffer holding an incomplete
+     * record carried over from the previous block.
+     */
+    size_t carried = 0;
+
+    if (buffer == NULL) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        return 1;
+    }
+
+    // Until the whole file has been read...
+    while (1) {
+        /**
+         * The number of new bytes read into the buffer.
+         */
+        size_t bytesRead = readBlock(input, buffer + carried,
+                                     BATCH_BLOCK_SIZE - carried);
+
+        /**
+         * One past the last byte available in the buffer.
+         */
+        const char *end = buffer + carried + bytesRead;
+
+        /**
+         * The first record left incomplete.
+         */
+        const char *rest;
+
+        if (bytesRead == 0) {
+            break;
+        }
+
+        // Process every complete record, keeping the rest for the next block.
+        rest    = processBinaryRecords(buffer, end, mergeOverlaps, output);
+        carried = end - rest;
+        memmove(buffer, rest, carried);
+    }
+
+    free(buffer);
+
+    // A record cut short means the file was damaged.
+    if (carried > 0) {
+        printError("[ERROR]\tBINARY PUNCH FILE ENDS PARTWAY THROUGH A DAY.\n",
+                   NULL, NULL);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Runs PUNCHCARD non-interactively over a binary punch file mapped into memory,
+ * reading the records straight out of the mapping.
+ *
+ * @param mapping       The mapped binary punch file to read.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ * @param output        The output buffer to write the results to.
+ *
+ * @return 0 if the whole file was processed, 1 if it could not be.
+ */
+int runMappedBinaryBatch(const struct InputMapping *mapping,
+                         int mergeOverlaps, struct OutputBuffer *output) {
+    /**
+     * The start of the next record to process, just past the header.
+     */
+    const char *cursor = mapping->data + BINARY_HEADER_SIZE;
+
+    /**
+     * One past the last byte of the file.
+     */
+    const char *end = mapping->data + mapping->size;
+
+    // Process a block's worth of records at a time, releasing each after.
+    while (cursor < end) {
+        /**
+         * The first record not processed this time around.
+         */
+        const char *rest = processBinaryRecords(
+                cursor, (size_t) (end - cursor) > BATCH_BLOCK_SIZE ?
+                        cursor + BATCH_BLOCK_SIZE : end, mergeOverlaps,
+                output);
+
+        if (rest == cursor) {
+            break;
+        }
+        releaseMappedRange(mapping, cursor - mapping->data,
+                           rest - mapping->data);
+        cursor = rest;
+    }
+
+    // A record cut short means the file was damaged.
+    if (cursor < end) {
+        printError("[ERROR]\tBINARY PUNCH FILE ENDS PARTWAY THROUGH A DAY.\n",
+                   NULL, NULL);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Checks whether the start of a file is the header of a binary punch file.
+ *
+ * @param header The first bytes of the file.
+ * @param size   The number of bytes available.
+ *
+ * @return 1 if the file is a binary punch file, 0 otherwise.
+ */
+int isBinaryPunchHeader(const char *header, size_t size) {
+    return size >= BINARY_HEADER_SIZE && memcmp(header, BINARY_MAGIC, 4) == 0 &&
+           header[4] == BINARY_VERSION;
+}
+
+/**
+ * Checks whether a file is a binary punch file by reading the start of it and
+ * looking for its header. The file is left just past the bytes read, which are
+ * kept, since a pipe can't be rewound to read them again.
+ *
+ * @param input  The file to check.
+ * @param header The buffer to read the start of the file into, with room for
+ *               BINARY_HEADER_SIZE bytes.
+ * @param size   A pointer to the size_t storing the number of bytes read.
+ *
+ * @return 1 if the file is a binary punch file, 0 otherwise.
+ */
+int isBinaryPunchFile(struct IoFile *input, char *header, size_t *size) {
+    *size = readBlock(input, header, BINARY_HEADER_SIZE);
+    return isBinaryPunchHeader(header, *size);
+}
+
+/**
+ * Runs batch mode over a file, reading it as a binary punch file if it is one,
+ * and as lines of times otherwise. The file is mapped into memory if possible,
+ * and read in blocks otherwise.
+ *
+ * @param path          The path of the file to read times from.
+ * @param threadCount   The number of threads to process text with.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      only once.
+ * @param output        The output buffer to write the results to.
+ *
+ * @return 0 if the whole file was processed, 1 if it could not be.
+ */
+int runBatchFile(const char *path, int threadCount, int mergeOverlaps,
+                 struct OutputBuffer *output) {
+    /**
+     * The file mapped into memory.
+     */
+    struct InputMapping mapping;
+
+    /**
+     * The file times are read from, if it could not be mapped.
+     */
+    struct IoFile *input;
+
+    /**
+     * What to do with each line of text.
+     */
+    LineHandler handler = findBatchLineHandler(&output->rounding,
+                                               mergeOverlaps);
+
+    /**
+     * The bytes read from the start of the file to check for a header.
+     */
+    char header[BINARY_HEADER_SIZE];
+
+    /**
+     * The number of bytes read from the start of the file.
+     */
+    size_t headerSize;
+
+    /**
+     * The value to exit with.
+     */
+    int status;
+
+    // Parse straight out of memory if we can.
+    if (mapInputFile(path, &mapping) == 0) {
+        if (isBinaryPunchHeader(mapping.data, mapping.size)) {
+            status = runMappedBinaryBatch(&mapping, mergeOverlaps, output);
+        } else {
+            status = runMappedBatch(&mapping, 0, threadCount, handler,
+                                    output);
+        }
+        unmapInputFile(&mapping);
+        return status;
+    }
+
+    // Otherwise, read the file a block at a time.
+    input = ioOpenRead(path);
+    if (input == NULL) {
+        printError("[ERROR]\tCOULD NOT OPEN \"", path, "\".\n");
+        return 1;
+    }
+    if (isBinaryPunchFile(input, header, &headerSize)) {
+        status = runBinaryBatch(input, mergeOverlaps, output);
+    } else {
+        status = runBatch(input, header, headerSize, threadCount, handler,
+                          output);
+    }
+    ioClose(input);
+    return status;
+}
+
+/**
+ * Converts a file with one day of times per line to a binary punch file, so it
+ * can be processed again later without parsing any text.
+ *
+ * @param inputPath   The path of the file to read times from.
+ * @param outputPath  The path of the binary punch file to write.
+ * @param threadCount The number of threads to convert the file with.
+ *
+ * @return 0 if the whole file was converted, 1 if it could not be.
+ */
+int runConvert(const char *inputPath, const char *outputPath,
+               int threadCount) {
+    /**
+     * The file mapped into memory.
+     */
+    struct InputMapping mapping;
+
+    /**
+     * The file times are read from, if it could not be mapped.
+     */
+    struct IoFile *input = NULL;
+
+    /**
+     * The binary punch file being written.
+     */
+    struct IoFile *binary;
+
+    /**
+     * The records collected so they can be written out in large pieces.
+     */
+    struct OutputBuffer records;
+
+    /**
+     * The header at the start of the binary punch file.
+     */
+    const char header[BINARY_HEADER_SIZE] = {
+            BINARY_MAGIC[0], BINARY_MAGIC[1], BINARY_MAGIC[2], BINARY_MAGIC[3],
+            BINARY_VERSION, 0, 0, 0};
+
+    /**
+     * The bytes read from the start of the file to check for a header, if it
+     * could not be mapped.
+     */
+    char start[BINARY_HEADER_SIZE];
+
+    /**
+     * The number of bytes read from the start of the file.
+     */
+    size_t startSize = 0;
+
+    /**
+     * Whether the file being converted is already a binary punch file.
+     */
+    int alreadyBinary;
+
+    /**
+     * The value to exit with.
+     */
+    int status;
+
+    // Map the file into memory if we can, or open it otherwise.
+    if (mapInputFile(inputPath, &mapping) == 0) {
+        alreadyBinary = isBinaryPunchHeader(mapping.data, mapping.size);
+    } else if ((input = ioOpenRead(inputPath)) != NULL) {
+        alreadyBinary = isBinaryPunchFile(input, start, &startSize);
+    } else {
+        printError("[ERROR]\tCOULD NOT OPEN \"", inputPath, "\".\n");
+        return 1;
+    }
+    if (alreadyBinary) {
+        printError("[ERROR]\t\"", inputPath,
+                   "\" IS ALREADY A BINARY PUNCH FILE.\n");
+        status = 1;
+    } else if ((binary = ioOpenWrite(outputPath)) == NULL) {
+        printError("[ERROR]\tCOULD NOT OPEN \"", outputPath, "\".\n");
+        status = 1;
+    } else if (outputOpen(&records, binary, OUTPUT_BUFFER_SIZE) == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        ioClose(binary);
+        status = 1;
+    } else {
+        // Write the header, then a record for every line.
+        outputText(&records, header, BINARY_HEADER_SIZE);
+        if (input == NULL) {
+            status = runMappedBatch(&mapping, 0, threadCount,
+                                    convertBatchLine, &records);
+        } else {
+            status = runBatch(input, start, startSize, threadCount,
+                              convertBatchLine, &records);
+        }
+        outputClose(&records);
+        if (ioClose(binary) == -1) {
+            printError("[ERROR]\tCOULD NOT WRITE \"", outputPath, "\".\n");
+            status = 1;
+        }
+    }
+
+    // Clean up.
+    if (input == NULL) {
+        unmapInputFile(&mapping);
+    } else {
+        ioClose(input);
+    }
+    return status;
+}
+
+/**
+ * Makes sure a growable array has room for at least the given number of
+ * elements, doubling its capacity as many times as it takes.
+ *
+ * @param array       The array to grow, or NULL if it hasn't been allocated.
+ * @param capacity    A pointer to the number of elements the array has room
+ *                    for, updated if it grows.
+ * @param needed      The number of elements the array needs room for.
+ * @param elementSize The size of each element.
+ *
+ * @return The array, which may have moved, or NULL if there was no memory to
+ *         grow it, in which case the original array is left as it was.
+ */
+void *growArray(void *array, size_t *capacity, size_t needed,
+                size_t elementSize) {
+    /**
+     * The number of elements the grown array will have room for.
+     */
+    size_t newCapacity = *capacity == 0 ? 64 : *capacity;
+
+    if (needed <= *capacity) {
+        return array;
+    }
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+    array = realloc(array, newCapacity * elementSize);
+    if (array != NULL) {
+        *capacity = newCapacity;
+    }
+    return array;
+}
+
+/**
+ * Hashes the text of an employee ID with 32-bit FNV-1a.
+ *
+ * @param name   The text of the ID.
+ * @param length The number of characters in the ID.
+ *
+ * @return The hash of the ID, never 0.
+ */
+uint32_t hashEmployeeName(const char *name, size_t length) {
+    /**
+     * The hash of the characters so far.
+     */
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char) name[i]) * 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+/**
+ * Hashes an employee and date together by multiplying them by the golden ratio
+ * and keeping the high bits, which every bit of the pair contributes to.
+ *
+ * @param employee The index of the employee's ID.
+ * @param date     The date, as the number of days since 1970-01-01.
+ *
+ * @return The hash of the pair, never 0.
+ */
+uint32_t hashEmployeeDay(uint32_t employee, int32_t date) {
+    /**
+     * The employee and date in one word, mixed.
+     */
+    uint64_t key = ((uint64_t) employee << 32 | (uint32_t) date) *
+                   UINT64_C(0x9E3779B97F4A7C15);
+
+    /**
+     * The hash of the pair.
+     */
+    uint32_t hash = (uint32_t) (key >> 32);
+
+    return hash == 0 ? 1 : hash;
+}
+
+/**
+ * Sets up an empty aggregation table.
+ *
+ * @param aggregation The aggregation table to set up.
+ *
+ * @return 0 if the table was set up, -1 if there was no memory for it.
+ */
+int openAggregation(struct Aggregation *aggregation) {
+    *aggregation = (struct Aggregation) {0};
+    aggregation->employees.slots = calloc(EMPLOYEE_INITIAL_SLOTS,
+                                          sizeof(uint32_t));
+    aggregation->employees.slotCount = EMPLOYEE_INITIAL_SLOTS;
+    aggregation->days = calloc(AGGREGATE_INITIAL_SLOTS,
+                               sizeof(struct EmployeeDay));
+    aggregation->slotCount = AGGREGATE_INITIAL_SLOTS;
+    if (aggregation->employees.slots == NULL || aggregation->days == NULL) {
+        free(aggregation->employees.slots);
+        free(aggregation->days);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Frees everything held by an aggregation table.
+ *
+ * @param aggregation The aggregation table to free.
+ */
+void closeAggregation(struct Aggregation *aggregation) {
+    free(aggregation->employees.names);
+    free(aggregation->employees.ids);
+    free(aggregation->employees.slots);
+    free(aggregation->days);
+    free(aggregation->touched);
+    *aggregation = (struct Aggregation) {0};
+}
+
+/**
+ * Doubles the number of slots in the table of employee IDs.
+ *
+ * @param employees The employee IDs to rehash.
+ *
+ * @return 0 if the table grew, -1 if there was no memory for it to.
+ */
+int growEmployeeSlots(struct EmployeeIds *employees) {
+    /**
+     * The number of slots in the grown table.
+     */
+    size_t slotCount = employees->slotCount * 2;
+
+    /**
+     * The grown table.
+     */
+    uint32_t *slots = calloc(slotCount, sizeof(uint32_t));
+
+    if (slots == NULL) {
+        return -1;
+    }
+
+    // Put every ID in the first free slot from its home slot.
+    for (size_t id = 0; id < employees->count; id++) {
+        /**
+         * The slot being tried.
+         */
+        size_t slot = employees->ids[id].hash & (slotCount - 1);
+
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        slots[slot] = (uint32_t) id + 1;
+    }
+
+    free(employees->slots);
+    employees->slots     = slots;
+    employees->slotCount = slotCount;
+    return 0;
+}
+
+/**
+ * Finds the index of an employee ID, interning it first if it hasn't been seen
+ * before.
+ *
+ * @param employees The employee IDs seen so far.
+ * @param name      The text of the ID, with no null characters.
+ * @param length    The number of characters in the ID.
+ * @param id        A pointer to the uint32_t to store the index of the ID in.
+ *
+ * @return 0 if the ID was found or interned, -1 if there was no memory to
+ *         intern it.
+ */
+int internEmployee(struct EmployeeIds *employees, const char *name,
+                   size_t length, uint32_t *id) {
+    /**
+     * The hash of the ID.
+     */
+    uint32_t hash = hashEmployeeName(name, length);
+
+    /**
+     * The slot being tried.
+     */
+    size_t slot = hash & (employees->slotCount - 1);
+
+    /**
+     * The grown arrays of names and IDs.
+     */
+    void *grown;
+
+    // Look for the ID from its home slot until reaching an empty one.
+    while (employees->slots[slot] != 0) {
+        /**
+         * The ID in this slot.
+         */
+        const struct EmployeeId *candidate =
+                &employees->ids[employees->slots[slot] - 1];
+
+        /**
+         * The text of the ID in this slot.
+         */
+        const char *candidateName = employees->names + candidate->name;
+
+        if (candidate->hash == hash &&
+            strncmp(candidateName, name, length) == 0 &&
+            candidateName[length] == '\0') {
+            *id = employees->slots[slot] - 1;
+            return 0;
+        }
+        slot = (slot + 1) & (employees->slotCount - 1);
+    }
+
+    // It's new, so copy it in, keeping offsets and indexes within 32 bits.
+    if (employees->namesLength + length + 1 > UINT32_MAX ||
+        employees->count + 1 >= UINT32_MAX) {
+        return -1;
+    }
+    grown = growArray(employees->names, &employees->namesCapacity,
+                      employees->namesLength + length + 1, 1);
+    if (grown == NULL) {
+        return -1;
+    }
+    employees->names = grown;
+    grown = growArray(employees->ids, &employees->capacity,
+                      employees->count + 1, sizeof(struct EmployeeId));
+    if (grown == NULL) {
+        return -1;
+    }
+    employees->ids = grown;
+    memcpy(employees->names + employees->namesLength, name, length);
+    employees->names[employees->namesLength + length] = '\0';
+    employees->ids[employees->count] = (struct EmployeeId) {
+            (uint32_t) employees->namesLength, hash};
+    employees->namesLength += length + 1;
+    *id = (uint32_t) employees->count++;
+    employees->slots[slot] = *id + 1;
+
+    // Keep the table at most half full, so misses end quickly.
+    if (employees->count * 2 > employees->slotCount) {
+        return growEmployeeSlots(employees);
+    }
+    return 0;
+}
+
+/**
+ * Puts a new entry in the table of employee days. Moving out from the entry's
+ * home slot, any entry closer to its own home slot is displaced to make room
+ * and carried on to the next slot in its place, which keeps every entry about
+ * as far from home as every other.
+ *
+ * @param days The table of employee days.
+ * @param mask One less than the number of slots in the table.
+ * @param day  The entry to put in the table.
+ */
+void placeEmployeeDay(struct EmployeeDay *days, size_t mask,
+                      struct EmployeeDay day) {
+    /**
+     * The slot being tried.
+     */
+    size_t slot = day.hash & mask;
+
+    /**
+     * How far the slot is from the home slot of the entry being carried.
+     */
+    size_t distance = 0;
+
+    while (days[slot].hash != 0) {
+        /**
+         * How far the slot is from the home slot of the entry already in it.
+         */
+        size_t slotDistance = (slot - (days[slot].hash & mask)) & mask;
+
+        if (slotDistance < distance) {
+            /**
+             * The entry displaced, to be carried on from here.
+             */
+            struct EmployeeDay displaced = days[slot];
+
+            days[slot] = day;
+            day        = displaced;
+            distance   = slotDistance;
+        }
+        slot = (slot + 1) & mask;
+        distance++;
+    }
+    days[slot] = day;
+}
+
+/**
+ * Doubles the number of slots in the table of employee days.
+ *
+ * @param aggregation The aggregation table to grow.
+ *
+ * @return 0 if the table grew, -1 if there was no memory for it to.
+ */
+int growEmployeeDays(struct Aggregation *aggregation) {
+    /**
+     * The number of slots in the grown table.
+     */
+    size_t slotCount = aggregation->slotCount * 2;
+
+    /**
+     * The grown table.
+     */
+    struct EmployeeDay *days = calloc(slotCount, sizeof(struct EmployeeDay));
+
+    if (days == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < aggregation->slotCount; i++) {
+        if (aggregation->days[i].hash != 0) {
+            placeEmployeeDay(days, slotCount - 1, aggregation->days[i]);
+        }
+    }
+
+    free(aggregation->days);
+    aggregation->days      = days;
+    aggregation->slotCount = slotCount;
+    return 0;
+}
+
+/**
+ * Finds the entry for an employee and date in the table of employee days.
+ *
+ * @param aggregation The aggregation table to look in.
+ * @param employee    The index of the employee's ID.
+ * @param date        The date, as the number of days since 1970-01-01.
+ *
+ * @return The entry for the employee and date, or NULL if there isn't one.
+ */
+struct EmployeeDay *findEmployeeDay(struct Aggregation *aggregation,
+                                    uint32_t employee, int32_t date) {
+    /**
+     * The hash of the employee and date.
+     */
+    uint32_t hash = hashEmployeeDay(employee, date);
+
+    /**
+     * One less than the number of slots in the table.
+     */
+    size_t mask = aggregation->slotCount - 1;
+
+    /**
+     * The slot being tried.
+     */
+    size_t slot = hash & mask;
+
+    /**
+     * How far the slot is from the home slot of the employee and date.
+     */
+    size_t distance = 0;
+
+    // Look for the employee and date from its home slot. Once an entry closer
+    // to its own home slot turns up, it can't be any further along.
+    while (aggregation->days[slot].hash != 0 &&
+           ((slot - (aggregation->days[slot].hash & mask)) & mask) >=
+           distance) {
+        /**
+         * The entry in this slot.
+         */
+        struct EmployeeDay *day = &aggregation->days[slot];
+
+        if (day->hash == hash && day->employee == employee &&
+            day->date == date) {
+            return day;
+        }
+        slot = (slot + 1) & mask;
+        distance++;
+    }
+    return NULL;
+}
+
+/**
+ * Adds time worked by an employee on a date to their total for it, noting the
+ * change if changes are being tracked.
+ *
+ * @param aggregation The aggregation table to add to.
+ * @param employee    The index of the employee's ID.
+ * @param date        The date, as the number of days since 1970-01-01.
+ * @param minutes     The minutes worked.
+ *
+ * @return 0 if the time was added, -1 if there was no memory to add it.
+ */
+int addEmployeeDay(struct Aggregation *aggregation, uint32_t employee,
+                   int32_t date, int minutes) {
+    /**
+     * The existing entry for the employee and date, if any.
+     */
+    struct EmployeeDay *day = findEmployeeDay(aggregation, employee, date);
+
+    // Note the change, so only the days that changed are written again.
+    if (aggregation->tracking) {
+        /**
+         * The grown list of changed days.
+         */
+        struct EmployeeDay *touched = growArray(
+                aggregation->touched, &aggregation->touchedCapacity,
+                aggregation->touchedCount + 1, sizeof(struct EmployeeDay));
+
+        if (touched == NULL) {
+            return -1;
+        }
+        aggregation->touched = touched;
+        touched[aggregation->touchedCount++] =
+                (struct EmployeeDay) {0, employee, date, 0};
+    }
+
+    if (day != NULL) {
+        day->minutes += minutes;
+        return 0;
+    }
+
+    // It's new, so add it, keeping the table at most seven-eighths full.
+    if ((aggregation->dayCount + 1) * 8 > aggregation->slotCount * 7 &&
+        growEmployeeDays(aggregation) == -1) {
+        return -1;
+    }
+    placeEmployeeDay(aggregation->days, aggregation->slotCount - 1,
+                     (struct EmployeeDay) {hashEmployeeDay(employee, date),
+                                           employee, date, minutes});
+    aggregation->dayCount++;
+    return 0;
+}
+
+/**
+ * Tells the user a line of aggregate input could not be read.
+ *
+ * @param lineNumber The number of the line, counting from 1.
+ */
+void reportUnreadableLine(size_t lineNumber) {
+    /**
+     * The line number as text.
+     */
+    char number[NUMBER_TEXT_SIZE + 1];
+
+    number[formatNumber(number, (int) lineNumber, 1)] = '\0';
+    printError("[ERROR]\tCOULD NOT READ LINE ", number, ".\n");
+}
+
+/**
+ * Warns the user that times on a line of aggregate input overlapped, and that
+ * the time they share was only counted once.
+ *
+ * @param lineNumber The number of the line, counting from 1.
+ */
+void reportOverlappingLine(size_t lineNumber) {
+    /**
+     * The line number as text.
+     */
+    char number[NUMBER_TEXT_SIZE + 1];
+
+    number[formatNumber(number, (int) lineNumber, 1)] = '\0';
+    printError("[WARNING]\tOVERLAPPING TIMES ON LINE ", number,
+               " COUNTED ONCE.\n");
+}
+
+/**
+ * Warns the user that a field of times on a line of aggregate input couldn't
+ * be read and was skipped, while the rest of the line was kept.
+ *
+ * @param lineNumber The number of the line, counting from 1.
+ * @param column     The column the field starts at, counting from 1.
+ */
+void reportSkippedField(size_t lineNumber, int column) {
+    /**
+     * The line number and column as text.
+     */
+    char place[NUMBER_TEXT_SIZE * 2 + 10];
+
+    /**
+     * The number of characters of the place written so far.
+     */
+    size_t length = formatNumber(place, (int) lineNumber, 1);
+
+    memcpy(place + length, ", COLUMN ", 9);
+    length += 9;
+    length += formatNumber(place + length, column, 1);
+    place[length] = '\0';
+    printError("[WARNING]\tSKIPPED UNREADABLE TIME ON LINE ", place, ".\n");
+}
+
+/**
+ * Saves what can be saved of the times on a line of aggregate input that
+ * couldn't be read whole, warning about each field skipped.
+ *
+ * @param aggregation  The aggregation table the line is being added to.
+ * @param line         A pointer to the first character of the line.
+ * @param times        A pointer to the first character of the times.
+ * @param end          A pointer one past the last character of the line.
+ * @param totalMinutes A pointer to the int storing the total minutes worked.
+ * @param day          The struct MergedDay to store the merged totals in, if
+ *                     overlaps are being merged.
+ *
+ * @return The number of intervals read, or -1 if the line still couldn't be
+ *         read.
+ */
+int recoverAggregateTimes(const struct Aggregation *aggregation,
+                          const char *line, const char *times,
+                          const char *end, int *totalMinutes,
+                          struct MergedDay *day) {
+    /**
+     * What could be read of the times, kept off the stack since it is large.
+     */
+    static thread_local struct RecoveredLine recovered;
+
+    if (recoverLine(&recovered, times, end, &statistics.counters) == -1 ||
+        (aggregation->mergeOverlaps &&
+         recovered.count > MERGE_MAX_INTERVALS)) {
+        return -1;
+    }
+    for (int i = 0; i < recovered.skippedCount; i++) {
+        reportSkippedField(aggregation->lineNumber,
+                           (int) (times - line) + recovered.skipped[i] + 1);
+    }
+    if (aggregation->mergeOverlaps) {
+        mergeIntervals(recovered.intervals, recovered.count, day);
+    } else {
+        *totalMinutes = sumRecoveredLine(&recovered, NULL, NULL);
+    }
+    return recovered.count;
+}
+
+/**
+ * Reads a single line of aggregate input, in the format "EMPLOYEE DATE TIMES",
+ * where EMPLOYEE is an employee ID with no whitespace in it, DATE is a date in
+ * the format YYYY-MM-DD, and TIMES is the times worked that day in the same
+ * format batch mode reads. The times are added to the employee's total for
+ * the date. Blank lines are skipped, and lines that can't be read are reported
+ * and skipped. If overlaps are being merged, time covered by more than one
+ * interval on the line is counted once, with a warning.
+ *
+ * @param aggregation The aggregation table to add the line to.
+ * @param line        A pointer to the first character of the line.
+ * @param end         A pointer one past the last character of the line, not
+ *                    including the newline.
+ *
+ * @return 0 if the line was dealt with, -1 if there was no memory to add it.
+ */
+int aggregateLine(struct Aggregation *aggregation, const char *line,
+                  const char *end) {
+    /**
+     * The position in the line being read.
+     */
+    const char *cursor = line;
+
+    /**
+     * The first character of the employee ID.
+     */
+    const char *employee;
+
+    /**
+     * One past the last character of the employee ID.
+     */
+    const char *employeeEnd;
+
+    /**
+     * The date the times were worked on.
+     */
+    int32_t date;
+
+    /**
+     * The total minutes worked on the line.
+     */
+    int totalMinutes = 0;
+
+    /**
+     * The merged totals for the line, if overlaps are being merged.
+     */
+    struct MergedDay day = {0};
+
+    /**
+     * The index of the employee's ID.
+     */
+    uint32_t id;
+
+    /**
+     * The number of intervals on the line.
+     */
+    int count;
+
+    aggregation->lineNumber++;
+    skipBufferSpace(&cursor, end);
+    if (cursor == end) {
+        return 0;
+    }
+    statistics.counters.lines++;
+
+    // Read the employee ID up to the first whitespace or control character.
+    employee = cursor;
+    while (cursor < end && (unsigned char) *cursor > ' ') {
+        cursor++;
+    }
+    employeeEnd = cursor;
+
+    // If something was wrong with the line, say so and move on.
+    if (cursor == end || (*cursor != ' ' && *cursor != '\t') ||
+        parseDate(&cursor, end, &date) == -1 || cursor == end ||
+        (*cursor != ' ' && *cursor != '\t')) {
+        statistics.counters.errorLines++;
+        statistics.counters.errors[LINE_BAD_EMPLOYEE_OR_DATE]++;
+        reportUnreadableLine(aggregation->lineNumber);
+        return 0;
+    }
+    count = aggregation->mergeOverlaps ?
+            mergeTimesInLine(cursor, end, &day) :
+            sumTimesInLine(cursor, end, &totalMinutes);
+    if (count == -1 && aggregation->recover) {
+        count = recoverAggregateTimes(aggregation, line, cursor, end,
+                                      &totalMinutes, &day);
+    }
+    if (count == -1) {
+        countUnreadableLine(&statistics.counters, cursor, end);
+        reportUnreadableLine(aggregation->lineNumber);
+        return 0;
+    }
+    statistics.counters.intervals += (uint64_t) count;
+    if (aggregation->mergeOverlaps) {
+        totalMinutes = day.minutes;
+        if (day.conflicts > 0) {
+            reportOverlappingLine(aggregation->lineNumber);
+        }
+    }
+
+    if (internEmployee(&aggregation->employees, employee,
+                       employeeEnd - employee, &id) == -1) {
+        return -1;
+    }
+    return addEmployeeDay(aggregation, id, date, totalMinutes);
+}
+
+/**
+ * Reads every complete line of aggregate input in a buffer.
+ *
+ * @param aggregation The aggregation table to add the lines to.
+ * @param begin       A pointer to the first character of the buffer.
+ * @param end         A pointer one past the last character of the buffer.
+ * @param rest        A pointer to the pointer to store the start of the first
+ *                    line without a newline in.
+ *
+ * @return 0 if every line was dealt with, -1 if there was no memory to add
+ *         one.
+ */
+int aggregateLines(struct Aggregation *aggregation, const char *begin,
+                   const char *end, const char **rest) {
+    /**
+     * The newline ending the line being read.
+     */
+    const char *newline;
+
+    while ((newline = memchr(begin, '\n', end - begin)) != NULL) {
+        if (aggregateLine(aggregation, begin, newline) == -1) {
+            return -1;
+        }
+        begin = newline + 1;
+    }
+    *rest = begin;
+    return 0;
+}
+
+/**
+ * Sets up checkpoints for an aggregate run.
+ *
+ * @param checkpoint The checkpoint settings to set up.
+ * @param path       The path of the checkpoint file.
+ * @param seconds    The seconds between checkpoints.
+ *
+ * @return 0 if the checkpoints were set up, -1 if there was no memory to.
+ */
+int openCheckpoint(struct Checkpoint *checkpoint, const char *path,
+                   int seconds) {
+    /**
+     * The length of the path of the checkpoint file.
+     */
+    size_t length = strlen(path);
+
+    checkpoint->path          = path;
+    checkpoint->temporaryPath = malloc(length + 5);
+    checkpoint->seconds       = seconds;
+    checkpoint->last          = time(NULL);
+    checkpoint->failed        = 0;
+    checkpoint->identity      = 0;
+    checkpoint->sample.headLength = 0;
+    checkpoint->sample.tailLength = 0;
+    if (checkpoint->temporaryPath == NULL) {
+        return -1;
+    }
+    memcpy(checkpoint->temporaryPath, path, length);
+    memcpy(checkpoint->temporaryPath + length, ".tmp", 5);
+    return 0;
+}
+
+/**
+ * Frees everything held by checkpoint settings.
+ *
+ * @param checkpoint The checkpoint settings to free.
+ */
+void closeCheckpoint(struct Checkpoint *checkpoint) {
+    free(checkpoint->temporaryPath);
+    checkpoint->temporaryPath = NULL;
+}
+
+/**
+ * Adds the next bytes read of aggregate input to its sample, keeping the first
+ * bytes of the input and the last bytes read.
+ *
+ * @param sample The sample of the input read so far.
+ * @param bytes  The bytes read, just after those already sampled.
+ * @param length The number of bytes read.
+ */
+void sampleInput(struct InputSample *sample, const char *bytes,
+                 size_t length) {
+    /**
+     * The number of bytes still to go in the head.
+     */
+    size_t headRoom = CHECKPOINT_SAMPLE_SIZE - sample->headLength;
+
+    /**
+     * The number of bytes of the old tail kept.
+     */
+    size_t kept;
+
+    if (length == 0) {
+        return;
+    }
+    if (headRoom > 0) {
+        memcpy(sample->head + sample->headLength, bytes,
+               length < headRoom ? length : headRoom);
+        sample->headLength += length < headRoom ? length : headRoom;
+    }
+
+    // Keep as much of the old tail as there is room for before the new bytes.
+    if (length >= CHECKPOINT_SAMPLE_SIZE) {
+        memcpy(sample->tail, bytes + length - CHECKPOINT_SAMPLE_SIZE,
+               CHECKPOINT_SAMPLE_SIZE);
+        sample->tailLength = CHECKPOINT_SAMPLE_SIZE;
+        return;
+    }
+    kept = CHECKPOINT_SAMPLE_SIZE - length < sample->tailLength ?
+           CHECKPOINT_SAMPLE_SIZE - length : sample->tailLength;
+    memmove(sample->tail, sample->tail + sample->tailLength - kept, kept);
+    memcpy(sample->tail + kept, bytes, length);
+    sample->tailLength = kept + length;
+}
+
+/**
+ * Hashes a sample of aggregate input with 64-bit FNV-1a, identifying the input
+ * up to where it was sampled.
+ *
+ * @param sample The sample of the input.
+ * @param offset The number of bytes of the input sampled.
+ *
+ * @return The identity of the input.
+ */
+uint64_t identifyInput(const struct InputSample *sample, uint64_t offset) {
+    /**
+     * The hash of everything so far, starting from the number of bytes.
+     */
+    uint64_t hash = 14695981039346656037u ^ offset;
+
+    for (size_t i = 0; i < sample->headLength; i++) {
+        hash = (hash ^ (unsigned char) sample->head[i]) * 1099511628211u;
+    }
+    for (size_t i = 0; i < sample->tailLength; i++) {
+        hash = (hash ^ (unsigned char) sample->tail[i]) * 1099511628211u;
+    }
+    return hash;
+}
+
+/**
+ * Writes a checkpoint file holding everything an aggregate run needs to carry
+ * on from where it is: how far into the input it has read, the identity of the
+ * input up to there, and the table so far. The header is followed by the text
+ * of every employee ID in the order they were interned, each with a null
+ * terminator, and then by the employee, date, and minutes of every employee
+ * day as 32-bit numbers, all least significant byte first. The file is written
+ * next to the checkpoint file, synced, and then renamed over it, so a crash at
+ * any point leaves either the old checkpoint or the new one whole.
+ *
+ * @param checkpoint  The checkpoint settings.
+ * @param aggregation The aggregation table to save.
+ * @param offset      The offset in the input of the first line not yet added
+ *                    to the table.
+ *
+ * @return 0 if the checkpoint was written, -1 if it could not be.
+ */
+int writeCheckpoint(const struct Checkpoint *checkpoint,
+                    const struct Aggregation *aggregation, uint64_t offset) {
+    /**
+     * The file the checkpoint is written to before taking the place of the
+     * last one.
+     */
+    struct IoFile *file = ioOpenWrite(checkpoint->temporaryPath);
+
+    /**
+     * The checkpoint, collected so it can be written out in large pieces.
+     */
+    struct OutputBuffer output;
+
+    /**
+     * Whether the checkpoint reached the disk.
+     */
+    int status;
+
+    if (file == NULL) {
+        return -1;
+    }
+    if (outputOpen(&output, file, OUTPUT_BUFFER_SIZE) == -1) {
+        ioClose(file);
+        ioRemove(checkpoint->temporaryPath);
+        return -1;
+    }
+
+    // Write the header.
+    outputText(&output, CHECKPOINT_MAGIC, 4);
+    outputChar(&output, CHECKPOINT_VERSION);
+    outputChar(&output,
+               (aggregation->mergeOverlaps ? CHECKPOINT_MERGED : 0) |
+               (aggregation->recover ? CHECKPOINT_RECOVERED : 0));
+    outputText(&output, "\0\0", 2);
+    outputUint64(&output, offset);
+    outputUint64(&output, aggregation->lineNumber);
+    outputUint64(&output, aggregation->employees.count);
+    outputUint64(&output, aggregation->employees.namesLength);
+    outputUint64(&output, aggregation->dayCount);
+    outputUint64(&output, identifyInput(&checkpoint->sample, offset));
+
+    // Write the employee IDs, then the days.
+    if (aggregation->employees.namesLength > 0) {
+        outputText(&output, aggregation->employees.names,
+                   aggregation->employees.namesLength);
+    }
+    for (size_t i = 0; i < aggregation->slotCount; i++) {
+        if (aggregation->days[i].hash != 0) {
+            outputUint32(&output, aggregation->days[i].employee);
+            outputUint32(&output, (uint32_t) aggregation->days[i].date);
+            outputUint32(&output, (uint32_t) aggregation->days[i].minutes);
+        }
+    }
+    outputClose(&output);
+
+    // Only replace the last checkpoint once this one is safely on disk.
+    status = ioSync(file);
+    if (ioClose(file) == -1 || status == -1 ||
+        ioReplace(checkpoint->temporaryPath, checkpoint->path) == -1) {
+        ioRemove(checkpoint->temporaryPath);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Writes a checkpoint if it has been long enough since the last one. A
+ * checkpoint that can't be written is reported the first time, but doesn't
+ * stop the run.
+ *
+ * @param checkpoint  The checkpoint settings, or NULL if checkpoints aren't
+ *                    being written.
+ * @param aggregation The aggregation table to save.
+ * @param offset      The offset in the input of the first line not yet added
+ *                    to the table.
+ */
+void saveCheckpointIfDue(struct Checkpoint *checkpoint,
+                         const struct Aggregation *aggregation,
+                         uint64_t offset) {
+    /**
+     * The current time.
+     */
+    time_t now;
+
+    if (checkpoint == NULL) {
+        return;
+    }
+    now = time(NULL);
+    if (difftime(now, checkpoint->last) < checkpoint->seconds) {
+        return;
+    }
+    checkpoint->last = now;
+    if (writeCheckpoint(checkpoint, aggregation, offset) == -1 &&
+        !checkpoint->failed) {
+        printError("[ERROR]\tCOULD NOT WRITE CHECKPOINT \"", checkpoint->path,
+                   "\".\n");
+        checkpoint->failed = 1;
+    }
+}
+
+/**
+ * Fills in an empty aggregation table from the contents of a checkpoint file,
+ * as written by writeCheckpoint().
+ *
+ * @param data        The contents of the checkpoint file.
+ * @param size        The size of the checkpoint file.
+ * @param aggregation The empty aggregation table to fill in.
+ * @param offset      A pointer to the uint64_t to store the offset in the
+ *                    input to carry on from in.
+ * @param identity    A pointer to the uint64_t to store the identity of the
+ *                    input up to the offset in.
+ *
+ * @return 0 if the table was filled in, -1 if there was no memory to, -2 if
+ *         the checkpoint file is damaged, or -3 if it was written by a run that
+ *         did not treat overlapping times or unreadable lines the same way.
+ */
+int parseCheckpoint(const char *data, size_t size,
+                    struct Aggregation *aggregation, uint64_t *offset,
+                    uint64_t *identity) {
+    /**
+     * The number of employee IDs, the length of their text, and the number
+     * of employee days.
+     */
+    uint64_t employeeCount, namesLength, dayCount;
+
+    /**
+     * The next part of the checkpoint to read.
+     */
+    const char *cursor = data + CHECKPOINT_HEADER_SIZE;
+
+    /**
+     * One past the text of the last employee ID.
+     */
+    const char *namesEnd;
+
+    // Check the header, and that the file is exactly as long as it says.
+    if (size < CHECKPOINT_HEADER_SIZE ||
+        memcmp(data, CHECKPOINT_MAGIC, 4) != 0 ||
+        data[4] != CHECKPOINT_VERSION) {
+        return -2;
+    }
+    if (data[5] != ((aggregation->mergeOverlaps ? CHECKPOINT_MERGED : 0) |
+                    (aggregation->recover ? CHECKPOINT_RECOVERED : 0))) {
+        return -3;
+    }
+    *offset                 = readUint64(data + 8);
+    aggregation->lineNumber = readUint64(data + 16);
+    employeeCount           = readUint64(data + 24);
+    namesLength             = readUint64(data + 32);
+    dayCount                = readUint64(data + 40);
+    *identity               = readUint64(data + 48);
+    size                   -= CHECKPOINT_HEADER_SIZE;
+    if (namesLength > size ||
+        dayCount != (size - namesLength) / CHECKPOINT_DAY_SIZE ||
+        (size - namesLength) % CHECKPOINT_DAY_SIZE != 0 ||
+        (namesLength > 0 && cursor[namesLength - 1] != '\0')) {
+        return -2;
+    }
+    namesEnd = cursor + namesLength;
+
+    // Intern the employee IDs in the same order, so they keep their indexes.
+    for (uint64_t id = 0; id < employeeCount; id++) {
+        /**
+         * The length of the ID.
+         */
+        size_t length;
+
+        /**
+         * The index the ID was interned at.
+         */
+        uint32_t interned;
+
+        if (cursor == namesEnd || *cursor == '\0') {
+            return -2;
+        }
+        length = strlen(cursor);
+        if (internEmployee(&aggregation->employees, cursor, length,
+                           &interned) == -1) {
+            return -1;
+        }
+        if (interned != id) {
+            return -2;
+        }
+        cursor += length + 1;
+    }
+    if (cursor != namesEnd) {
+        return -2;
+    }
+
+    // Put back every employee day.
+    for (uint64_t i = 0; i < dayCount; i++, cursor += CHECKPOINT_DAY_SIZE) {
+        if (readUint32(cursor) >= employeeCount) {
+            return -2;
+        }
+        if (addEmployeeDay(aggregation, readUint32(cursor),
+                           (int32_t) readUint32(cursor + 4),
+                           (int32_t) readUint32(cursor + 8)) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Reads the whole of a file into memory, for files that can't be mapped.
+ *
+ * @param file The file to read.
+ * @param size A pointer to store the number of bytes read in.
+ *
+ * @return The contents of the file, to be freed by the caller, or NULL if there
+ *         was no memory for them.
+ */
+char *readWholeFile(struct IoFile *file, size_t *size) {
+    /**
+     * The contents of the file.
+     */
+    char *data = NULL;
+
+    /**
+     * The number of bytes there is room for.
+     */
+    size_t capacity = 0;
+
+    *size = 0;
+    while (1) {
+        /**
+         * The grown buffer.
+         */
+        char *grown = growArray(data, &capacity, *size + BATCH_BLOCK_SIZE, 1);
+
+        /**
+         * The number of bytes read this time around.
+         */
+        size_t bytesRead;
+
+        if (grown == NULL) {
+            free(data);
+            return NULL;
+        }
+        data      = grown;
+        bytesRead = readBlock(file, data + *size, capacity - *size);
+        if (bytesRead == 0) {
+            return data;
+        }
+        *size += bytesRead;
+    }
+}
+
+/**
+ * Loads the progress saved in a checkpoint file into an empty aggregation
+ * table, if there is a checkpoint file.
+ *
+ * @param checkpoint  The checkpoint settings.
+ * @param aggregation The empty aggregation table to fill in.
+ * @param offset      A pointer to the uint64_t to store the offset in the
+ *                    input to carry on from in, left alone if there is no
+ *                    checkpoint file.
+ *
+ * @return 1 if a checkpoint was loaded, 0 if there wasn't one, or -1 if it
+ *         could not be loaded.
+ */
+int loadCheckpoint(struct Checkpoint *checkpoint,
+                   struct Aggregation *aggregation, uint64_t *offset) {
+    /**
+     * The checkpoint file.
+     */
+    struct IoFile *file = ioOpenRead(checkpoint->path);
+
+    /**
+     * The contents of the checkpoint file.
+     */
+    char *data;
+
+    /**
+     * The number of bytes read in.
+     */
+    size_t size;
+
+    /**
+     * Whether the checkpoint could be loaded.
+     */
+    int status = -1;
+
+    if (file == NULL) {
+        return 0;
+    }
+    data = readWholeFile(file, &size);
+    ioClose(file);
+
+    if (data != NULL) {
+        status = parseCheckpoint(data, size, aggregation, offset,
+                                 &checkpoint->identity);
+    }
+    free(data);
+    if (status == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        return -1;
+    }
+    if (status == -2) {
+        printError("[ERROR]\tCHECKPOINT \"", checkpoint->path,
+                   "\" IS DAMAGED.\n");
+        return -1;
+    }
+    if (status == -3) {
+        printError("[ERROR]\tCHECKPOINT \"", checkpoint->path,
+                   "\" WAS WRITTEN WITH A DIFFERENT --merge-overlaps OR "
+                   "--recover.\n");
+        return -1;
+    }
+    return 1;
+}
+
+/**
+ * Reads every line of an aggregate input file mapped into memory, straight out
+ * of the mapping.
+ *
+ * @param aggregation The aggregation table to add the lines to.
+ * @param mapping     The mapped file to read.
+ * @param offset      The offset in the file of the first line to read.
+ * @param checkpoint  The checkpoint settings, or NULL if checkpoints aren't
+ *                    being written.
+ *
+ * @return 0 if every line was dealt with, -1 if there was no memory to add
+ *         one, -2 if the file is shorter than the offset, or -4 if the
+ *         checkpoint carried on from was taken of another file.
+ */
+int aggregateMappedFile(struct Aggregation *aggregation,
+                        const struct InputMapping *mapping, uint64_t offset,
+                        struct Checkpoint *checkpoint) {
+    /**
+     * The start of the next line to read.
+     */
+    const char *cursor = mapping->data + offset;
+
+    /**
+     * One past the last byte of the file.
+     */
+    const char *end = mapping->data + mapping->size;
+
+    if (offset > mapping->size) {
+        return -2;
+    }
+
+    // Make sure the checkpoint carried on from was taken of this file.
+    if (checkpoint != NULL) {
+        sampleInput(&checkpoint->sample, mapping->data, offset);
+        if (offset > 0 && identifyInput(&checkpoint->sample, offset) !=
+                          checkpoint->identity) {
+            return -4;
+        }
+    }
+
+    // Read a block's worth of lines at a time, releasing each after.
+    while (cursor < end) {
+        /**
+         * The first line not read this time around.
+         */
+        const char *rest;
+
+        if (aggregateLines(aggregation, cursor,
+                           (size_t) (end - cursor) > BATCH_BLOCK_SIZE ?
+                           cursor + BATCH_BLOCK_SIZE : end, &rest) == -1) {
+            return -1;
+        }
+
+        // A line longer than a block, or a last line with no newline, is read
+        // on its own.
+        if (rest == cursor) {
+            /**
+             * The newline ending the line, if it has one.
+             */
+            const char *newline = memchr(cursor, '\n', end - cursor);
+
+            if (aggregateLine(aggregation, cursor,
+                              newline == NULL ? end : newline) == -1) {
+                return -1;
+            }
+            rest = newline == NULL ? end : newline + 1;
+        }
+        if (checkpoint != NULL) {
+            sampleInput(&checkpoint->sample, cursor, rest - cursor);
+        }
+        releaseMappedRange(mapping, cursor - mapping->data,
+                           rest - mapping->data);
+        cursor = rest;
+        saveCheckpointIfDue(checkpoint, aggregation, cursor - mapping->data);
+    }
+    return 0;
+}
+
+/**
+ * Reads every complete line of aggregate input from a file until reaching its
+ * end, keeping any incomplete line after them for next time, so a file still
+ * being written to can be read again from where this left off. Lines longer
+ * than a block are reported as unreadable.
+ *
+ * @param aggregation The aggregation table to add the lines to.
+ * @param reader      The reader holding what has been read so far.
+ * @param input       The file to read.
+ * @param checkpoint  The checkpoint settings, or NULL if checkpoints aren't
+ *                    being written.
+ *
+ * @return 0 if every line was dealt with, -1 if there was no memory to add
+ *         one.
+ */
+int readAggregateInput(struct Aggregation *aggregation,
+                       struct AggregateReader *reader, struct IoFile *input,
+                       struct Checkpoint *checkpoint) {
+    // Until the end of the file...
+    while (1) {
+        /**
+         * The number of new bytes read into the buffer.
+         */
+        size_t bytesRead = readBlock(input, reader->buffer + reader->carried,
+                                     BATCH_BLOCK_SIZE - reader->carried);
+
+        /**
+         * The start of the next line to read.
+         */
+        const char *cursor = reader->buffer;
+
+        /**
+         * One past the last byte available in the buffer.
+         */
+        const char *end = reader->buffer + reader->carried + bytesRead;
+
+        /**
+         * The first line left incomplete.
+         */
+        const char *rest;
+
+        if (bytesRead == 0) {
+            return 0;
+        }
+
+        // Skip to the end of a line too long to read.
+        if (reader->discarding) {
+            rest = memchr(cursor, '\n', end - cursor);
+            if (rest == NULL) {
+                if (checkpoint != NULL) {
+                    sampleInput(&checkpoint->sample, reader->buffer,
+                                end - reader->buffer);
+                }
+                reader->offset += end - reader->buffer;
+                continue;
+            }
+            cursor             = rest + 1;
+            reader->discarding = 0;
+        }
+
+        // Read every complete line, keeping the rest for the next block.
+        if (aggregateLines(aggregation, cursor, end, &rest) == -1) {
+            return -1;
+        }
+        reader->carried = end - rest;
+        if (reader->carried == BATCH_BLOCK_SIZE) {
+            reportUnreadableLine(++aggregation->lineNumber);
+            reader->carried    = 0;
+            reader->discarding = 1;
+        }
+        if (checkpoint != NULL) {
+            sampleInput(&checkpoint->sample, reader->buffer,
+                        (end - reader->buffer) - reader->carried);
+        }
+        reader->offset += (end - reader->buffer) - reader->carried;
+        memmove(reader->buffer, rest, reader->carried);
+
+        // The middle of a line too long to read is no place to carry on from.
+        if (!reader->discarding) {
+            saveCheckpointIfDue(checkpoint, aggregation, reader->offset);
+        }
+    }
+}
+
+/**
+ * Reads every line of an aggregate input file a block at a time.
+ *
+ * @param aggregation The aggregation table to add the lines to.
+ * @param input       The file to read.
+ * @param offset      The offset in the file of the first line to read. Since
+ *                    the file may not be seekable, everything before it is
+ *                    read and thrown away.
+ * @param checkpoint  The checkpoint settings, or NULL if checkpoints aren't
+ *                    being written.
+ *
+ * @return 0 if every line was dealt with, -1 if there was no memory to add
+ *         one, -2 if the file is shorter than the offset, or -4 if the
+ *         checkpoint carried on from was taken of another file.
+ */
+int aggregateFile(struct Aggregation *aggregation, struct IoFile *input,
+                  uint64_t offset, struct Checkpoint *checkpoint) {
+    /**
+     * What has been read so far.
+     */
+    struct AggregateReader reader = {malloc(BATCH_BLOCK_SIZE), 0, 0, 0};
+
+    /**
+     * Whether there was memory for every line.
+     */
+    int status;
+
+    if (reader.buffer == NULL) {
+        return -1;
+    }
+
+    // Skip whatever was read before the checkpoint.
+    while (reader.offset < offset) {
+        /**
+         * The number of bytes skipped this time around.
+         */
+        size_t skipped = readBlock(input, reader.buffer,
+                                   offset - reader.offset < BATCH_BLOCK_SIZE ?
+                                   (size_t) (offset - reader.offset) :
+                                   BATCH_BLOCK_SIZE);
+
+        if (skipped == 0) {
+            free(reader.buffer);
+            return -2;
+        }
+        if (checkpoint != NULL) {
+            sampleInput(&checkpoint->sample, reader.buffer, skipped);
+        }
+        reader.offset += skipped;
+    }
+
+    // Make sure the checkpoint carried on from was taken of this file.
+    if (checkpoint != NULL && offset > 0 &&
+        identifyInput(&checkpoint->sample, offset) != checkpoint->identity) {
+        free(reader.buffer);
+        return -4;
+    }
+    status = readAggregateInput(aggregation, &reader, input, checkpoint);
+
+    // Finish off a last line with no newline on its own.
+    if (status == 0 && reader.carried > 0) {
+        status = aggregateLine(aggregation, reader.buffer,
+                               reader.buffer + reader.carried);
+    }
+
+    free(reader.buffer);
+    return status;
+}
+
+/**
+ * Compares two employee IDs by name, for qsort().
+ *
+ * @param a A pointer to the first struct EmployeeName.
+ * @param b A pointer to the second struct EmployeeName.
+ *
+ * @return Less than, equal to, or greater than 0 as the first name sorts
+ *         before, with, or after the second.
+ */
+int compareEmployeeNames(const void *a, const void *b) {
+    return strcmp(((const struct EmployeeName *) a)->name,
+                  ((const struct EmployeeName *) b)->name);
+}
+
+/**
+ * Compares two employee days by employee, then by date, for qsort().
+ *
+ * @param a A pointer to the first struct EmployeeDay.
+ * @param b A pointer to the second struct EmployeeDay.
+ *
+ * @return Less than, equal to, or greater than 0 as the first day sorts
+ *         before, with, or after the second.
+ */
+int compareEmployeeDays(const void *a, const void *b) {
+    /**
+     * The days being compared.
+     */
+    const struct EmployeeDay *first = a, *second = b;
+
+    if (first->employee != second->employee) {
+        return first->employee < second->employee ? -1 : 1;
+    }
+    return (first->date > second->date) - (first->date < second->date);
+}
+
+/**
+ * Writes the report line for an employee day: the employee ID, the date, and
+ * then the same result line batch mode writes for a day, separated by tabs.
+ *
+ * @param output         The output buffer to write the line to.
+ * @param employee       The ID of the employee.
+ * @param date           The date, as the number of days since 1970-01-01.
+ * @param minutes        The total minutes worked.
+ * @param roundedMinutes The total minutes worked, rounded.
+ */
+void outputEmployeeDay(struct OutputBuffer *output, const char *employee,
+                       int32_t date, int minutes, int roundedMinutes) {
+    /**
+     * The date as text.
+     */
+    char text[DATE_TEXT_SIZE];
+
+    outputString(output, employee);
+    outputChar(output, '\t');
+    outputText(output, text, formatDate(text, date));
+    outputChar(output, '\t');
+    outputRoundedDayResult(output, minutes, roundedMinutes);
+}
+
+/**
+ * Finds the Monday a week starts on.
+ *
+ * @param date A date in the week, as the number of days since 1970-01-01.
+ *
+ * @return The Monday on or before the date, as the number of days since
+ *         1970-01-01.
+ */
+int32_t startOfWeek(int32_t date) {
+    // 1970-01-01 was a Thursday, three days after a Monday.
+    return date - ((date + 3) % 7 + 7) % 7;
+}
+
+/**
+ * Finds the Monday a pay period starts on.
+ *
+ * @param policy    The rollup policy setting out the pay periods.
+ * @param weekStart The Monday starting a week in the pay period, as the number
+ *                  of days since 1970-01-01.
+ *
+ * @return The Monday the pay period starts on, as the number of days since
+ *         1970-01-01.
+ */
+int32_t startOfPayPeriod(const struct RollupPolicy *policy,
+                         int32_t weekStart) {
+    /**
+     * The number of days in a pay period.
+     */
+    int32_t length = policy->periodWeeks * 7;
+
+    return weekStart - ((weekStart - policy->periodStart) % length + length) %
+                       length;
+}
+
+/**
+ * Writes a rollup line: the employee ID, what is being rolled up, the date it
+ * starts on, the rounded total hours, and the overtime hours, separated by
+ * tabs.
+ *
+ * @param output   The output buffer to write the line to.
+ * @param employee The ID of the employee.
+ * @param label    What is being rolled up.
+ * @param start    The date it starts on, as the number of days since
+ *                 1970-01-01.
+ * @param minutes  The rounded minutes worked.
+ * @param overtime The minutes of overtime worked.
+ */
+void outputRollupLine(struct OutputBuffer *output, const char *employee,
+                      const char *label, int32_t start, int minutes,
+                      int overtime) {
+    /**
+     * The start date as text.
+     */
+    char date[DATE_TEXT_SIZE];
+
+    outputString(output, employee);
+    outputChar(output, '\t');
+    outputString(output, label);
+    outputChar(output, '\t');
+    outputText(output, date, formatDate(date, start));
+    outputChar(output, '\t');
+    outputHours(output, minutes);
+    outputChar(output, '\t');
+    outputHours(output, overtime);
+    outputChar(output, '\n');
+}
+
+/**
+ * Closes the current week of a rollup, writing its line and adding it to the
+ * pay period. Anything over the weekly limit that isn't already daily overtime
+ * is overtime too.
+ *
+ * @param rollup The rollup to close the week of.
+ * @param policy The rollup policy to apply.
+ * @param output The output buffer to write the week's line to.
+ */
+void closeRollupWeek(struct Rollup *rollup, const struct RollupPolicy *policy,
+                     struct OutputBuffer *output) {
+    /**
+     * The overtime worked in the week.
+     */
+    int overtime = rollup->weekDailyOvertime;
+
+    if (policy->weeklyOvertime > 0 &&
+        rollup->weekMinutes - overtime > policy->weeklyOvertime) {
+        overtime = rollup->weekMinutes - policy->weeklyOvertime;
+    }
+    outputRollupLine(output, rollup->employee, "WEEK", rollup->weekStart,
+                     rollup->weekMinutes, overtime);
+    rollup->periodMinutes    += rollup->weekMinutes;
+    rollup->periodOvertime   += overtime;
+    rollup->weekMinutes       = 0;
+    rollup->weekDailyOvertime = 0;
+}
+
+/**
+ * Closes the current pay period of a rollup, writing its line.
+ *
+ * @param rollup The rollup to close the pay period of, whose week has already
+ *               been closed.
+ * @param output The output buffer to write the pay period's line to.
+ */
+void closeRollupPeriod(struct Rollup *rollup, struct OutputBuffer *output) {
+    outputRollupLine(output, rollup->employee, "PERIOD", rollup->periodStart,
+                     rollup->periodMinutes, rollup->periodOvertime);
+    rollup->periodMinutes  = 0;
+    rollup->periodOvertime = 0;
+}
+
+/**
+ * Adds a day to a rollup, first closing the week and pay period before it if
+ * the day falls after them, or if it belongs to another employee. Days must be
+ * added sorted by employee and then date, so only the current week and pay
+ * period ever need to be kept.
+ *
+ * @param rollup   The rollup to add to.
+ * @param policy   The rollup policy to apply.
+ * @param employee The ID of the employee who worked the day.
+ * @param date     The date, as the number of days since 1970-01-01.
+ * @param minutes  The minutes worked, rounded, since everything is rolled up
+ *                 from the rounded day.
+ * @param output   The output buffer to write closed weeks and pay periods to.
+ */
+void addRollupDay(struct Rollup *rollup, const struct RollupPolicy *policy,
+                  const char *employee, int32_t date, int minutes,
+                  struct OutputBuffer *output) {
+    /**
+     * The Monday the day's week starts on.
+     */
+    int32_t weekStart = startOfWeek(date);
+
+    // Close whatever the day falls outside of.
+    if (rollup->employee != employee || rollup->weekStart != weekStart) {
+        /**
+         * The Monday the day's pay period starts on.
+         */
+        int32_t periodStart = startOfPayPeriod(policy, weekStart);
+
+        if (rollup->employee != NULL) {
+            closeRollupWeek(rollup, policy, output);
+            if (rollup->employee != employee ||
+                rollup->periodStart != periodStart) {
+                closeRollupPeriod(rollup, output);
+            }
+        }
+        rollup->employee    = employee;
+        rollup->weekStart   = weekStart;
+        rollup->periodStart = periodStart;
+    }
+
+    rollup->weekMinutes += minutes;
+    if (policy->dailyOvertime > 0 && minutes > policy->dailyOvertime) {
+        rollup->weekDailyOvertime += minutes - policy->dailyOvertime;
+    }
+}
+
+/**
+ * Closes the last week and pay period of a rollup, if any.
+ *
+ * @param rollup The rollup to finish.
+ * @param policy The rollup policy to apply.
+ * @param output The output buffer to write the closing lines to.
+ */
+void finishRollup(struct Rollup *rollup, const struct RollupPolicy *policy,
+                  struct OutputBuffer *output) {
+    if (rollup->employee != NULL) {
+        closeRollupWeek(rollup, policy, output);
+        closeRollupPeriod(rollup, output);
+        rollup->employee = NULL;
+    }
+}
+
+/**
+ * Copies every employee day out of an aggregation table, sorted by employee ID
+ * and then by date, so the table can still be added to after. The IDs are
+ * sorted by name once first, and each day copied is given its employee's place
+ * in that order, so the days can be sorted by number.
+ *
+ * @param aggregation The aggregation table to sort.
+ * @param names       A pointer to store the employee IDs sorted by name in,
+ *                    to be freed by the caller.
+ * @param days        A pointer to store the sorted days in, to be freed by the
+ *                    caller. The employee of each is an index into names.
+ * @param count       A pointer to store the number of days in.
+ *
+ * @return 0 if the days were sorted, -1 if there was no memory to.
+ */
+int sortAggregation(const struct Aggregation *aggregation,
+                    struct EmployeeName **names, struct EmployeeDay **days,
+                    size_t *count) {
+    /**
+     * The position of each employee ID once sorted, by index.
+     */
+    uint32_t *ranks;
+
+    /**
+     * The number of employee days copied so far.
+     */
+    size_t packed = 0;
+
+    *names = malloc((aggregation->employees.count + 1) * sizeof(**names));
+    ranks  = malloc((aggregation->employees.count + 1) * sizeof(*ranks));
+    *days  = malloc((aggregation->dayCount + 1) * sizeof(**days));
+    if (*names == NULL || ranks == NULL || *days == NULL) {
+        free(*names);
+        free(ranks);
+        free(*days);
+        return -1;
+    }
+
+    // Sort the IDs by name once, so the days can be sorted by number.
+    for (size_t id = 0; id < aggregation->employees.count; id++) {
+        (*names)[id].name = aggregation->employees.names +
+                            aggregation->employees.ids[id].name;
+        (*names)[id].id   = (uint32_t) id;
+    }
+    qsort(*names, aggregation->employees.count, sizeof(**names),
+          compareEmployeeNames);
+    for (size_t rank = 0; rank < aggregation->employees.count; rank++) {
+        ranks[(*names)[rank].id] = (uint32_t) rank;
+    }
+
+    // Copy the days out of the table, then sort them.
+    for (size_t i = 0; i < aggregation->slotCount; i++) {
+        if (aggregation->days[i].hash != 0) {
+            (*days)[packed]          = aggregation->days[i];
+            (*days)[packed].employee = ranks[aggregation->days[i].employee];
+            packed++;
+        }
+    }
+    qsort(*days, packed, sizeof(**days), compareEmployeeDays);
+
+    free(ranks);
+    *count = packed;
+    return 0;
+}
+
+/**
+ * Writes the report line for each sorted employee day, rolling each up first
+ * if there is a rollup policy. Inlined into outputAggregation() once for each
+ * rounding policy, with the policy's step and threshold as constants.
+ *
+ * @param names   The employee IDs, sorted by name.
+ * @param days    The employee days, sorted, each with its employee as an index
+ *                into names.
+ * @param count   The number of employee days.
+ * @param policy  The rollup policy to apply, or NULL for no rollups.
+ * @param rollup  The running totals for the current week and pay period.
+ * @param output  The output buffer to write the report to.
+ * @param step    The step the rounding policy rounds to a multiple of.
+ * @param firstUp The fewest minutes past a step the policy rounds up.
+ */
+static PUNCHCARD_ALWAYS_INLINE void outputSortedDays(
+        const struct EmployeeName *names, const struct EmployeeDay *days,
+        size_t count, const struct RollupPolicy *policy, struct Rollup *rollup,
+        struct OutputBuffer *output, int step, int firstUp) {
+    for (size_t i = 0; i < count; i++) {
+        /**
+         * The ID of the employee who worked the day.
+         */
+        const char *employee = names[days[i].employee].name;
+
+        /**
+         * The minutes worked in the day, rounded.
+         */
+        int rounded = roundToStep(days[i].minutes, step, firstUp);
+
+        if (policy != NULL) {
+            addRollupDay(rollup, policy, employee, days[i].date, rounded,
+                         output);
+        }
+        outputEmployeeDay(output, employee, days[i].date, days[i].minutes,
+                          rounded);
+    }
+}
+
+/**
+ * Writes the report for every employee day aggregated, sorted by employee ID
+ * and then by date with sortAggregation(). Each line holds the employee ID, the
+ * date, and then the same result line batch mode writes for a day, all
+ * separated by tabs.
+ *
+ * With a rollup policy, each week and pay period is also rolled up as the
+ * days are written, in the same pass, with its line following its last day.
+ *
+ * @param aggregation The aggregation table to report on.
+ * @param policy      The rollup policy to apply, or NULL for no rollups.
+ * @param output      The output buffer to write the report to.
+ *
+ * @return 0 if the report was written, -1 if there was no memory to sort it.
+ */
+int outputAggregation(struct Aggregation *aggregation,
+                      const struct RollupPolicy *policy,
+                      struct OutputBuffer *output) {
+    /**
+     * The running totals for the current week and pay period.
+     */
+    struct Rollup rollup = {0};
+
+    /**
+     * The employee IDs, sorted by name.
+     */
+    struct EmployeeName *names;
+
+    /**
+     * The employee days, copied out of the table and sorted.
+     */
+    struct EmployeeDay *days;
+
+    /**
+     * The number of employee days.
+     */
+    size_t count;
+
+    if (sortAggregation(aggregation, &names, &days, &count) == -1) {
+        return -1;
+    }
+    switch (output->rounding.policy) {
+#define OUTPUT_SORTED_DAYS(name, rounding, step, firstUp) \
+        case rounding: \
+            outputSortedDays(names, days, count, policy, &rollup, output, \
+                             step, firstUp); \
+            break;
+        ROUNDING_POLICIES(OUTPUT_SORTED_DAYS)
+#undef OUTPUT_SORTED_DAYS
+    }
+    if (policy != NULL) {
+        finishRollup(&rollup, policy, output);
+    }
+
+    free(names);
+    free(days);
+    return 0;
+}
+
+/**
+ * Compares two changed employee days by employee ID, then by date, for
+ * qsort().
+ *
+ * @param a A pointer to the first struct ChangedDay.
+ * @param b A pointer to the second struct ChangedDay.
+ *
+ * @return Less than, equal to, or greater than 0 as the first day sorts
+ *         before, with, or after the second.
+ */
+int compareChangedDays(const void *a, const void *b) {
+    /**
+     * The days being compared.
+     */
+    const struct ChangedDay *first = a, *second = b;
+
+    /**
+     * How the employee IDs compare.
+     */
+    int order = strcmp(first->employee, second->employee);
+
+    if (order != 0) {
+        return order;
+    }
+    return (first->date > second->date) - (first->date < second->date);
+}
+
+/**
+ * Writes the report line for each sorted changed day, once however many times
+ * it changed. Inlined into outputChangedDays() once for each rounding policy,
+ * with the policy's step and threshold as constants.
+ *
+ * @param days    The changed days, sorted by employee and date.
+ * @param count   The number of changed days.
+ * @param output  The output buffer to write the report lines to.
+ * @param step    The step the rounding policy rounds to a multiple of.
+ * @param firstUp The fewest minutes past a step the policy rounds up.
+ */
+static PUNCHCARD_ALWAYS_INLINE void outputChangedDayLines(
+        const struct ChangedDay *days, size_t count,
+        struct OutputBuffer *output, int step, int firstUp) {
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || compareChangedDays(&days[i - 1], &days[i]) != 0) {
+            outputEmployeeDay(output, days[i].employee, days[i].date,
+                              days[i].minutes,
+                              roundToStep(days[i].minutes, step, firstUp));
+        }
+    }
+}
+
+/**
+ * Writes the report line for every employee day changed since the last time
+ * this was called, sorted by employee and date, then forgets the changes. Only
+ * the days changed are looked up and rounded again, so this costs as much as
+ * the new lines did, no matter how much was read before them.
+ *
+ * @param aggregation The aggregation table tracking changes.
+ * @param output      The output buffer to write the report lines to.
+ *
+ * @return 0 if the lines were written, -1 if there was no memory to sort them.
+ */
+int outputChangedDays(struct Aggregation *aggregation,
+                      struct OutputBuffer *output) {
+    /**
+     * The current totals for the changed days.
+     */
+    struct ChangedDay *days = malloc((aggregation->touchedCount + 1) *
+                                     sizeof(*days));
+
+    if (days == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < aggregation->touchedCount; i++) {
+        /**
+         * The change noted.
+         */
+        const struct EmployeeDay *touched = &aggregation->touched[i];
+
+        days[i].employee = aggregation->employees.names +
+                           aggregation->employees.ids[touched->employee].name;
+        days[i].date     = touched->date;
+        days[i].minutes  = findEmployeeDay(aggregation, touched->employee,
+                                           touched->date)->minutes;
+    }
+    qsort(days, aggregation->touchedCount, sizeof(*days), compareChangedDays);
+
+    // Write each day once, however many times it changed.
+    switch (output->rounding.policy) {
+#define OUTPUT_CHANGED_DAYS(name, policy, step, firstUp) \
+        case policy: \
+            outputChangedDayLines(days, aggregation->touchedCount, output, \
+                                  step, firstUp); \
+            break;
+        ROUNDING_POLICIES(OUTPUT_CHANGED_DAYS)
+#undef OUTPUT_CHANGED_DAYS
+    }
+
+    free(days);
+    aggregation->touchedCount = 0;
+    return 0;
+}
+
+/**
+ * Starts watching a file for changes, if the platform can say when it
+ * changes.
+ *
+ * @param path The path of the file to watch.
+ *
+ * @return The inotify instance watching the file, or -1 if it has to be
+ *         checked for changes every so often instead.
+ */
+int openFileWatch(const char *path) {
+#if defined(PUNCHCARD_INOTIFY)
+    /**
+     * The inotify instance watching the file.
+     */
+    int watch = inotify_init1(IN_CLOEXEC);
+
+    if (watch != -1 &&
+        inotify_add_watch(watch, path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF |
+                                       IN_DELETE_SELF) == -1) {
+        close(watch);
+        watch = -1;
+    }
+    return watch;
+#else
+    (void) path;
+    return -1;
+#endif
+}
+
+/**
+ * Waits until a watched file has changed, or might have. A signal, such as one
+ * asking for the statistics, ends the wait early.
+ *
+ * @param watch The inotify instance watching the file, or -1 to wait for
+ *              FOLLOW_POLL_SECONDS instead.
+ */
+void waitForFileChange(int watch) {
+#if defined(PUNCHCARD_INOTIFY)
+    /**
+     * The events waited for. Which ones happened doesn't matter, since the
+     * file is looked at again after any of them.
+     */
+    _Alignas(struct inotify_event) char events[4096];
+
+    /**
+     * The number of bytes of events read.
+     */
+    ssize_t bytesRead = watch == -1 ? 0 : read(watch, events, sizeof(events));
+
+    if (bytesRead > 0 || (bytesRead == -1 && errno == EINTR)) {
+        return;
+    }
+#else
+    (void) watch;
+#endif
+    thrd_sleep(&(struct timespec) {.tv_sec = FOLLOW_POLL_SECONDS}, NULL);
+}
+
+/**
+ * Stops watching a file for changes.
+ *
+ * @param watch The inotify instance watching the file, or -1 if there isn't
+ *              one.
+ */
+void closeFileWatch(int watch) {
+#if defined(PUNCHCARD_INOTIFY)
+    if (watch != -1) {
+        close(watch);
+    }
+#else
+    (void) watch;
+#endif
+}
+
+/**
+ * Looks up which file is at a path and how big it is.
+ *
+ * @param path     The path to look at.
+ * @param identity The identity to fill in.
+ *
+ * @return 0 if the file was looked up, -1 if there is no file at the path or
+ *         the platform can't say.
+ */
+int identifyFile(const char *path, struct FileIdentity *identity) {
+#if defined(PUNCHCARD_MMAP_POSIX)
+    /**
+     * Information about the file.
+     */
+    struct stat status;
+
+    if (stat(path, &status) == -1) {
+        return -1;
+    }
+    identity->device = (uint64_t) status.st_dev;
+    identity->inode  = (uint64_t) status.st_ino;
+    identity->size   = (uint64_t) status.st_size;
+    return 0;
+#else
+    (void) path;
+    (void) identity;
+    return -1;
+#endif
+}
+
+/**
+ * Starts following a file over again from its start, after it has been cut
+ * short or replaced by another file at the same path. The lines already read
+ * stay in the totals. Whatever is left of a replaced file is read first, so
+ * lines added just before it was rotated out aren't lost.
+ *
+ * @param aggregation The aggregation table the lines are added to.
+ * @param reader      The reader holding what has been read so far, emptied.
+ * @param input       A pointer to the file being followed, replaced with the
+ *                    file now at the path.
+ * @param path        The path of the file being followed.
+ * @param replaced    Whether the file was replaced, rather than cut short.
+ *
+ * @return 0 if the file was reopened, 1 if there is no file at the path yet,
+ *         or -1 if there was no memory to read the rest of the old file.
+ */
+int reopenFollowedFile(struct Aggregation *aggregation,
+                       struct AggregateReader *reader, struct IoFile **input,
+                       const char *path, int replaced) {
+    /**
+     * The file now at the path.
+     */
+    struct IoFile *reopened;
+
+    if (replaced &&
+        readAggregateInput(aggregation, reader, *input, NULL) == -1) {
+        return -1;
+    }
+    reopened = ioOpenRead(path);
+    if (reopened == NULL) {
+        return 1;
+    }
+    printError("[WARNING]\tFILE \"", path,
+               replaced ? "\" WAS REPLACED, READING THE NEW ONE FROM THE "
+                          "START.\n" :
+                          "\" WAS CUT SHORT, READING IT AGAIN FROM THE "
+                          "START.\n");
+    ioClose(*input);
+    *input                  = reopened;
+    reader->carried         = 0;
+    reader->discarding      = 0;
+    reader->offset          = 0;
+    aggregation->lineNumber = 0;
+    return 0;
+}
+
+/**
+ * Runs aggregate mode over a file that is still being written to. The report
+ * for everything in the file is written first, as in runAggregate(). After
+ * that, whenever lines are added to the file, only they are read, and the
+ * report line for each employee day they change is written again with its new
+ * total. If the file is cut short, or replaced as when logs are rotated, it is
+ * read again from the start. This carries on until the output can't be
+ * written.
+ *
+ * @param aggregation The empty aggregation table to fill in.
+ * @param path        The path of the file to follow.
+ * @param policy      The rollup policy to apply to the first report, or NULL
+ *                    for no rollups.
+ * @param output      The output buffer to write the report to.
+ *
+ * @return 1, since following only stops if something goes wrong.
+ */
+int followAggregate(struct Aggregation *aggregation, const char *path,
+                    const struct RollupPolicy *policy,
+                    struct OutputBuffer *output) {
+    /**
+     * The file being followed.
+     */
+    struct IoFile *input = ioOpenRead(path);
+
+    /**
+     * The inotify instance watching the file, if there is one.
+     */
+    int watch;
+
+    /**
+     * What has been read so far, including any incomplete line at the end.
+     */
+    struct AggregateReader reader = {NULL, 0, 0, 0};
+
+    /**
+     * The file being followed, and the file at its path when last looked.
+     */
+    struct FileIdentity followed, current;
+
+    /**
+     * Whether the file being followed is known, so it can be told apart from
+     * another put in its place.
+     */
+    int identified;
+
+    /**
+     * Whether there was memory for everything.
+     */
+    int status = 0;
+
+    if (input == NULL) {
+        printError("[ERROR]\tCOULD NOT OPEN \"", path, "\".\n");
+        return 1;
+    }
+    identified    = identifyFile(path, &followed) == 0;
+    watch         = openFileWatch(path);
+    reader.buffer = malloc(BATCH_BLOCK_SIZE);
+
+    // Report on what's there already, then on each day changed after.
+    if (reader.buffer == NULL ||
+        readAggregateInput(aggregation, &reader, input, NULL) == -1 ||
+        outputAggregation(aggregation, policy, output) == -1) {
+        status = -1;
+    }
+    aggregation->tracking = 1;
+    while (status == 0) {
+        outputFlush(output);
+        if (ioError(output->stream)) {
+            break;
+        }
+        waitForFileChange(watch);
+
+        // Start over if the file was cut short or something else is there
+        // now, checking every so often until the new file turns up, since the
+        // watch only sees the old one.
+        if (identified) {
+            /**
+             * Whether the file at the path is no longer the one being read.
+             */
+            int replaced = identifyFile(path, &current) == -1 ||
+                           current.device != followed.device ||
+                           current.inode != followed.inode;
+
+            /**
+             * Whether the file could be reopened.
+             */
+            int reopened = 1;
+
+            if (replaced || current.size < reader.offset + reader.carried) {
+                reopened = reopenFollowedFile(aggregation, &reader, &input,
+                                              path, replaced);
+                closeFileWatch(watch);
+                watch = -1;
+            }
+            if (reopened == -1) {
+                status = -1;
+                break;
+            }
+            if (reopened == 0) {
+                identified = identifyFile(path, &followed) == 0;
+                watch      = identified ? openFileWatch(path) : -1;
+            }
+        }
+        if (readAggregateInput(aggregation, &reader, input, NULL) == -1 ||
+            outputChangedDays(aggregation, output) == -1) {
+            status = -1;
+        }
+    }
+    if (status == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+    }
+
+    closeFileWatch(watch);
+    free(reader.buffer);
+    ioClose(input);
+    return 1;
+}
+
+/**
+ * Reads every line of an aggregate input file from an offset on, straight out
+ * of memory if the file can be mapped, and a block at a time otherwise.
+ *
+ * @param aggregation The aggregation table to add the lines to.
+ * @param path        The path of the file to read.
+ * @param offset      The offset in the file of the first line to read.
+ * @param checkpoint  The checkpoint settings, or NULL if checkpoints aren't
+ *                    being written.
+ *
+ * @return 0 if every line was dealt with, -1 if there was no memory to add
+ *         one, -2 if the file is shorter than the offset, -3 if the file could
+ *         not be opened, or -4 if the checkpoint carried on from was taken of
+ *         another file.
+ */
+int aggregateWholeFile(struct Aggregation *aggregation, const char *path,
+                       uint64_t offset, struct Checkpoint *checkpoint) {
+    /**
+     * The file mapped into memory.
+     */
+    struct InputMapping mapping;
+
+    /**
+     * The file times are read from, if it could not be mapped.
+     */
+    struct IoFile *input;
+
+    /**
+     * Whether every line was dealt with.
+     */
+    int status;
+
+    if (mapInputFile(path, &mapping) == 0) {
+        status = aggregateMappedFile(aggregation, &mapping, offset,
+                                     checkpoint);
+        unmapInputFile(&mapping);
+        return status;
+    }
+    input = ioOpenRead(path);
+    if (input == NULL) {
+        return -3;
+    }
+    status = aggregateFile(aggregation, input, offset, checkpoint);
+    ioClose(input);
+    return status;
+}
+
+/**
+ * Runs aggregate mode over a file with one employee day of times per line,
+ * adding up the time each employee worked on each date however many lines it
+ * is spread across, then writing a report sorted by employee and date. The
+ * file is mapped into memory if possible, and read in blocks otherwise.
+ *
+ * With checkpoints, progress is saved every so often, and a run finding a
+ * checkpoint left by one that was stopped carries on from it, writing the same
+ * report the stopped run would have. The checkpoint is deleted once the report
+ * has been written.
+ *
+ * @param path          The path of the file to read times from.
+ * @param policy        The rollup policy to apply, or NULL for no rollups.
+ * @param follow        Whether to carry on reading lines added to the file
+ *                      after, as followAggregate() does.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      on a line only once.
+ * @param checkpoint    The checkpoint settings, or NULL if checkpoints aren't
+ *                      being written.
+ * @param output        The output buffer to write the report to.
+ *
+ * @return 0 if the whole file was aggregated, 1 if it could not be.
+ */
+int runAggregate(const char *path, const struct RollupPolicy *policy,
+                 int follow, int mergeOverlaps, struct Checkpoint *checkpoint,
+                 struct OutputBuffer *output) {
+    /**
+     * The totals for every employee and date.
+     */
+    struct Aggregation aggregation;
+
+    /**
+     * The offset in the file to start reading from.
+     */
+    uint64_t offset = 0;
+
+    /**
+     * Whether there was memory for everything.
+     */
+    int status;
+
+    if (openAggregation(&aggregation) == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        return 1;
+    }
+    aggregation.mergeOverlaps = mergeOverlaps;
+    aggregation.recover       = output->recover;
+    if (follow) {
+        status = followAggregate(&aggregation, path, policy, output);
+        closeAggregation(&aggregation);
+        return status;
+    }
+
+    // Carry on from the last checkpoint, if there is one.
+    if (checkpoint != NULL &&
+        loadCheckpoint(checkpoint, &aggregation, &offset) == -1) {
+        closeAggregation(&aggregation);
+        return 1;
+    }
+
+    status = aggregateWholeFile(&aggregation, path, offset, checkpoint);
+    if (status == -3) {
+        printError("[ERROR]\tCOULD NOT OPEN \"", path, "\".\n");
+        closeAggregation(&aggregation);
+        return 1;
+    }
+
+    if (status == 0) {
+        status = outputAggregation(&aggregation, policy, output);
+    }
+    if (status == 0 && checkpoint != NULL) {
+        ioRemove(checkpoint->path);
+        ioRemove(checkpoint->temporaryPath);
+    }
+    if (status == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+    }
+    if (status == -2) {
+        printError("[ERROR]\tCHECKPOINT \"", checkpoint->path,
+                   "\" IS FOR A LONGER FILE.\n");
+    }
+    if (status == -4) {
+        printError("[ERROR]\tCHECKPOINT \"", checkpoint->path,
+                   "\" IS FOR A DIFFERENT FILE.\n");
+    }
+    closeAggregation(&aggregation);
+    return status == 0 ? 0 : 1;
+}
+
+/**
+ * Writes each sorted employee day of a range index, with the running totals for
+ * its employee. Inlined into writeIndex() once for each rounding policy, with
+ * the policy's step and threshold as constants.
+ *
+ * @param output  The output buffer the index is collected in.
+ * @param days    The employee days, sorted by employee and date.
+ * @param count   The number of employee days.
+ * @param step    The step the rounding policy rounds to a multiple of.
+ * @param firstUp The fewest minutes past a step the policy rounds up.
+ */
+static PUNCHCARD_ALWAYS_INLINE void outputIndexDays(
+        struct OutputBuffer *output, const struct EmployeeDay *days,
+        size_t count, int step, int firstUp) {
+    /**
+     * The actual and rounded minutes worked by the current employee so far.
+     */
+    uint64_t minutes = 0, roundedMinutes = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || days[i].employee != days[i - 1].employee) {
+            minutes        = 0;
+            roundedMinutes = 0;
+        }
+        minutes        += (uint64_t) days[i].minutes;
+        roundedMinutes += (uint64_t) roundToStep(days[i].minutes, step,
+                                                 firstUp);
+        outputUint32(output, (uint32_t) days[i].date);
+        outputUint64(output, minutes);
+        outputUint64(output, roundedMinutes);
+    }
+}
+
+/**
+ * Writes a range index file for every employee day aggregated, so the time an
+ * employee worked between any two dates can be looked up without reading the
+ * days again. After the header come the employees, sorted by ID, each as the
+ * index of its first day as a 64-bit number and the offset and length of its ID
+ * as 32-bit numbers. Then comes the text of every ID, and then every day,
+ * sorted by employee and date, as its date as a 32-bit number followed by the
+ * actual and rounded minutes worked by the employee up to and including that
+ * day as 64-bit numbers. Everything is stored least significant byte first.
+ * The file is written next to the index, synced, and then renamed over it, so
+ * anything querying the index while it is rebuilt sees the old one or the new
+ * one and never a mix of the two.
+ *
+ * @param path        The path of the range index file.
+ * @param aggregation The aggregation table to index.
+ * @param rounding    How to round each day for the rounded sums.
+ *
+ * @return 0 if the index was written, -1 if there was no memory to, or -2 if it
+ *         could not be written.
+ */
+int writeIndex(const char *path, const struct Aggregation *aggregation,
+               const struct Rounding *rounding) {
+    /**
+     * The employee IDs, sorted by name.
+     */
+    struct EmployeeName *names;
+
+    /**
+     * The employee days, copied out of the table and sorted.
+     */
+    struct EmployeeDay *days;
+
+    /**
+     * The number of employee days.
+     */
+    size_t count;
+
+    /**
+     * The path the index is written to before taking the place of the last
+     * one.
+     */
+    char *temporaryPath;
+
+    /**
+     * The index being written.
+     */
+    struct IoFile *file;
+
+    /**
+     * The index, collected so it can be written out in large pieces.
+     */
+    struct OutputBuffer output;
+
+    /**
+     * The length of the text of every ID.
+     */
+    uint64_t namesLength = 0;
+
+    /**
+     * The index of the next day to write, and of the first day of the next
+     * employee to write.
+     */
+    size_t day = 0;
+
+    /**
+     * Whether the index reached the disk.
+     */
+    int status = 0;
+
+    if (sortAggregation(aggregation, &names, &days, &count) == -1) {
+        return -1;
+    }
+    temporaryPath = malloc(strlen(path) + 5);
+    if (temporaryPath == NULL) {
+        free(names);
+        free(days);
+        return -1;
+    }
+    memcpy(temporaryPath, path, strlen(path));
+    memcpy(temporaryPath + strlen(path), ".tmp", 5);
+    file = ioOpenWrite(temporaryPath);
+    if (file == NULL || outputOpen(&output, file, OUTPUT_BUFFER_SIZE) == -1) {
+        if (file != NULL) {
+            ioClose(file);
+            ioRemove(temporaryPath);
+        }
+        free(temporaryPath);
+        free(names);
+        free(days);
+        return file == NULL ? -2 : -1;
+    }
+
+    // Write the header.
+    for (size_t rank = 0; rank < aggregation->employees.count; rank++) {
+        namesLength += strlen(names[rank].name);
+    }
+    outputText(&output, INDEX_MAGIC, 4);
+    outputChar(&output, INDEX_VERSION);
+    outputText(&output, "\0\0\0", 3);
+    outputUint64(&output, aggregation->employees.count);
+    outputUint64(&output, count);
+    outputUint64(&output, namesLength);
+
+    // Write each employee, with where its days and its ID start.
+    namesLength = 0;
+    for (size_t rank = 0; rank < aggregation->employees.count; rank++) {
+        /**
+         * The length of the employee's ID.
+         */
+        size_t length = strlen(names[rank].name);
+
+        outputUint64(&output, day);
+        outputUint32(&output, (uint32_t) namesLength);
+        outputUint32(&output, (uint32_t) length);
+        namesLength += length;
+        while (day < count && days[day].employee == rank) {
+            day++;
+        }
+    }
+    for (size_t rank = 0; rank < aggregation->employees.count; rank++) {
+        outputString(&output, names[rank].name);
+    }
+
+    // Write each day with the running totals for its employee.
+    switch (rounding->policy) {
+#define OUTPUT_INDEX_DAYS(name, policy, step, firstUp) \
+        case policy: \
+            outputIndexDays(&output, days, count, step, firstUp); \
+            break;
+        ROUNDING_POLICIES(OUTPUT_INDEX_DAYS)
+#undef OUTPUT_INDEX_DAYS
+    }
+
+    // Make sure the whole index is on disk before it replaces the last one.
+    outputClose(&output);
+    if (ioError(file) || ioSync(file) == -1) {
+        status = -2;
+    }
+    if (ioClose(file) == -1) {
+        status = -2;
+    }
+    if (status == 0 && ioReplace(temporaryPath, path) == -1) {
+        status = -2;
+    }
+    if (status != 0) {
+        ioRemove(temporaryPath);
+    }
+    free(temporaryPath);
+    free(names);
+    free(days);
+    return status;
+}
+
+/**
+ * Builds a range index file from a file with one employee day of times per
+ * line, read the same way aggregate mode reads it.
+ *
+ * @param inputPath     The path of the file to read times from.
+ * @param indexPath     The path of the range index file to write.
+ * @param mergeOverlaps Whether to count time covered by more than one interval
+ *                      on a line only once.
+ * @param recover       Whether to skip only the fields of a line that can't be
+ *                      read, rather than the whole line.
+ * @param rounding      How to round each day for the rounded sums.
+ *
+ * @return 0 if the index was built, 1 if it could not be.
+ */
+int runIndexBuild(const char *inputPath, const char *indexPath,
+                  int mergeOverlaps, int recover,
+                  const struct Rounding *rounding) {
+    /**
+     * The totals for every employee and date.
+     */
+    struct Aggregation aggregation;
+
+    /**
+     * Whether everything was read and written.
+     */
+    int status;
+
+    if (openAggregation(&aggregation) == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        return 1;
+    }
+    aggregation.mergeOverlaps = mergeOverlaps;
+    aggregation.recover       = recover;
+    status = aggregateWholeFile(&aggregation, inputPath, 0, NULL);
+    if (status == 0) {
+        status = writeIndex(indexPath, &aggregation, rounding);
+        if (status == -2) {
+            printError("[ERROR]\tCOULD NOT WRITE \"", indexPath, "\".\n");
+        }
+    } else if (status == -3) {
+        printError("[ERROR]\tCOULD NOT OPEN \"", inputPath, "\".\n");
+    }
+    if (status == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+    }
+    closeAggregation(&aggregation);
+    return status == 0 ? 0 : 1;
+}
+
+/**
+ * Finds the days of an employee in a range index file, by binary search over
+ * the employees sorted by ID.
+ *
+ * @param index    The contents of the range index file, already checked to
+ *                 be the size its header says.
+ * @param employee The ID of the employee to find.
+ * @param first    A pointer to store the index of the employee's first day in.
+ * @param last     A pointer to store one past the index of the employee's last
+ *                 day in.
+ *
+ * @return 1 if the employee was found, 0 if not, or -1 if the index is
+ *         damaged.
+ */
+int findIndexEmployee(const char *index, const char *employee,
+                      uint64_t *first, uint64_t *last) {
+    /**
+     * The number of employees and days in the index, and the length of the
+     * text of every ID.
+     */
+    uint64_t employeeCount = readUint64(index + 8),
+             dayCount = readUint64(index + 16),
+             namesLength = readUint64(index + 24);
+
+    /**
+     * The employees, and the text of every ID.
+     */
+    const char *employees = index + INDEX_HEADER_SIZE,
+               *names = employees + employeeCount * INDEX_EMPLOYEE_SIZE;
+
+    /**
+     * The length of the ID being looked for.
+     */
+    size_t length = strlen(employee);
+
+    /**
+     * The range of employees the ID could still be in.
+     */
+    uint64_t low = 0, high = employeeCount;
+
+    while (low < high) {
+        /**
+         * The employee in the middle of the range.
+         */
+        uint64_t middle = low + (high - low) / 2;
+
+        /**
+         * Where the employee's ID starts and how long it is.
+         */
+        const char *entry = employees + middle * INDEX_EMPLOYEE_SIZE;
+        uint32_t nameOffset = readUint32(entry + 8),
+                 nameLength = readUint32(entry + 12);
+
+        /**
+         * How the employee's ID compares to the one being looked for.
+         */
+        int order;
+
+        if ((uint64_t) nameOffset + nameLength > namesLength) {
+            return -1;
+        }
+        order = memcmp(names + nameOffset, employee,
+                       nameLength < length ? nameLength : length);
+        if (order == 0) {
+            order = (nameLength > length) - (nameLength < length);
+        }
+        if (order == 0) {
+            *first = readUint64(entry);
+            *last  = middle + 1 < employeeCount ?
+                     readUint64(entry + INDEX_EMPLOYEE_SIZE) : dayCount;
+            return *first <= *last && *last <= dayCount ? 1 : -1;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Finds the first of a run of days in a range index file falling after a date,
+ * by binary search.
+ *
+ * @param days  The days in the range index file.
+ * @param first The index of the first day of the run.
+ * @param last  One past the index of the last day of the run.
+ * @param date  The date, as the number of days since 1970-01-01.
+ *
+ * @return The index of the first day after the date, or last if there is none.
+ */
+uint64_t findIndexDayAfter(const char *days, uint64_t first, uint64_t last,
+                           int32_t date) {
+    while (first < last) {
+        /**
+         * The day in the middle of the run.
+         */
+        uint64_t middle = first + (last - first) / 2;
+
+        if ((int32_t) readUint32(days + middle * INDEX_DAY_SIZE) <= date) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+/**
+ * Answers how long an employee worked between two dates, inclusive, from a
+ * range index file. The index is mapped into memory if possible and only the
+ * few pieces of it the binary searches land on are ever read, so an answer
+ * takes the same time however much history the index holds. The answer is the
+ * employee ID, the two dates, the actual time as HH:MM, and the rounded hours,
+ * separated by tabs.
+ *
+ * @param indexPath The path of the range index file.
+ * @param employee  The ID of the employee.
+ * @param from      The first date, in the format YYYY-MM-DD.
+ * @param to        The last date, in the format YYYY-MM-DD.
+ * @param output    The output buffer to write the answer to.
+ *
+ * @return 0 if the question was answered, 1 if it could not be.
+ */
+int runIndexQuery(const char *indexPath, const char *employee,
+                  const char *from, const char *to,
+                  struct OutputBuffer *output) {
+    /**
+     * The first and last dates, as the number of days since 1970-01-01.
+     */
+    int32_t fromDate, toDate;
+
+    /**
+     * The positions in the dates being read.
+     */
+    const char *fromCursor = from, *toCursor = to;
+
+    /**
+     * The index mapped into memory.
+     */
+    struct InputMapping mapping;
+
+    /**
+     * The index read into memory, if it could not be mapped.
+     */
+    char *data = NULL;
+
+    /**
+     * The contents of the index, and its size.
+     */
+    const char *index;
+    size_t size;
+
+    /**
+     * The range of the employee's days, and of those between the dates.
+     */
+    uint64_t first, last, begin, end;
+
+    /**
+     * The totals of the days before the dates and up to the last one.
+     */
+    uint64_t minutesBefore = 0, roundedBefore = 0, minutesThrough = 0,
+             roundedThrough = 0;
+
+    /**
+     * The days in the index.
+     */
+    const char *days;
+
+    /**
+     * Whether the employee was found.
+     */
+    int found;
+
+    /**
+     * The dates as text.
+     */
+    char date[DATE_TEXT_SIZE];
+
+    if (parseDate(&fromCursor, from + strlen(from), &fromDate) == -1 ||
+        *fromCursor != '\0') {
+        printError("[ERROR]\tCOULD NOT READ DATE \"", from, "\".\n");
+        return 1;
+    }
+    if (parseDate(&toCursor, to + strlen(to), &toDate) == -1 ||
+        *toCursor != '\0') {
+        printError("[ERROR]\tCOULD NOT READ DATE \"", to, "\".\n");
+        return 1;
+    }
+    if (toDate < fromDate) {
+        printError("[ERROR]\t\"", to, "\" IS BEFORE THE FIRST DATE.\n");
+        return 1;
+    }
+
+    // Map the index into memory if we can, and read it in otherwise.
+    if (mapInputFile(indexPath, &mapping) == 0) {
+        index = mapping.data;
+        size  = mapping.size;
+    } else {
+        /**
+         * The index file.
+         */
+        struct IoFile *file = ioOpenRead(indexPath);
+
+        if (file == NULL) {
+            printError("[ERROR]\tCOULD NOT OPEN \"", indexPath, "\".\n");
+            return 1;
+        }
+        data = readWholeFile(file, &size);
+        ioClose(file);
+        if (data == NULL) {
+            printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+            return 1;
+        }
+        index = data;
+    }
+
+    // Check the header, and that the file is exactly as long as it says.
+    found = -1;
+    if (size >= INDEX_HEADER_SIZE && memcmp(index, INDEX_MAGIC, 4) == 0 &&
+        index[4] == INDEX_VERSION &&
+        readUint64(index + 8) <= size / INDEX_EMPLOYEE_SIZE &&
+        readUint64(index + 16) <= size / INDEX_DAY_SIZE &&
+        readUint64(index + 24) <= size &&
+        INDEX_HEADER_SIZE + readUint64(index + 8) * INDEX_EMPLOYEE_SIZE +
+        readUint64(index + 24) + readUint64(index + 16) * INDEX_DAY_SIZE ==
+        size) {
+        found = findIndexEmployee(index, employee, &first, &last);
+    }
+    if (found == -1) {
+        printError("[ERROR]\tINDEX \"", indexPath, "\" IS DAMAGED.\n");
+    } else if (found == 0) {
+        printError("[ERROR]\tNO EMPLOYEE \"", employee, "\" IN THE INDEX.\n");
+    } else {
+        // Take the running totals either side of the dates.
+        days  = index + size - readUint64(index + 16) * INDEX_DAY_SIZE;
+        begin = findIndexDayAfter(days, first, last, fromDate - 1);
+        end   = findIndexDayAfter(days, begin, last, toDate);
+        if (begin > first) {
+            minutesBefore = readUint64(days + (begin - 1) * INDEX_DAY_SIZE + 4);
+            roundedBefore = readUint64(days + (begin - 1) * INDEX_DAY_SIZE +
+                                       12);
+        }
+        if (end > first) {
+            minutesThrough = readUint64(days + (end - 1) * INDEX_DAY_SIZE + 4);
+            roundedThrough = readUint64(days + (end - 1) * INDEX_DAY_SIZE +
+                                        12);
+        }
+        minutesThrough -= minutesBefore;
+        roundedThrough -= roundedBefore;
+
+        outputString(output, employee);
+        outputChar(output, '\t');
+        outputText(output, date, formatDate(date, fromDate));
+        outputChar(output, '\t');
+        outputText(output, date, formatDate(date, toDate));
+        outputChar(output, '\t');
+        outputNumber(output, (int) (minutesThrough / 60), 2);
+        outputChar(output, ':');
+        outputNumber(output, (int) (minutesThrough % 60), 2);
+        outputChar(output, '\t');
+        outputHours(output, (int) roundedThrough);
+        outputChar(output, '\n');
+    }
+
+    if (data != NULL) {
+        free(data);
+    } else {
+        unmapInputFile(&mapping);
+    }
+    return found == 1 ? 0 : 1;
+}
 
-// Functions
+#if defined(PUNCHCARD_SERVE)
 /**
- * Consumes any unwanted characters in the input buffer until finding the EOF, a
- * newline, or the target character.
+ * Creates a Unix domain socket listening for clients at a path, replacing any
+ * socket left at the path before. Anything else at the path is left alone.
  *
- * @param target The target char to stop consuming characters after
- * encountering.
+ * @param path The path to listen at.
  *
- * @return -1 if stopped by EOF, 1 if stopped by a newline, 0 if stopped by the
- * target character, and 2 otherwise.
+ * @return The listening socket, or -1 if it could not be created or something
+ *         other than a socket is at the path.
  */
-int clearBufferJunk(char target) {
+int openServeSocket(const char *path) {
     /**
-     * The last character returned by getchar().
+     * The address of the socket.
      */
-    int lastCharacter;
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
 
-    // Consume characters from stdin until we encounter a stop condition.
-    while ((lastCharacter = getchar()) != target && lastCharacter != EOF &&
-           lastCharacter != '\n') {}
+    /**
+     * Information about whatever is already at the path.
+     */
+    struct stat existing;
 
-    // Return an int signifying the reason for stopping.
-    if (lastCharacter == EOF) {
+    /**
+     * The socket being created.
+     */
+    int listener;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
         return -1;
-    } else if (lastCharacter == target && target != '\n') {
-        return 0;
-    } else if (lastCharacter == '\n') {
-        return 1;
-    } else {
-        return 2;
     }
+
+    // Only a stale socket may be replaced, never an ordinary file.
+    if (lstat(path, &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            return -1;
+        }
+        unlink(path);
+    }
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener == -1) {
+        return -1;
+    }
+    if (bind(listener, (struct sockaddr *) &address, sizeof(address)) == -1 ||
+        listen(listener, SOMAXCONN) == -1) {
+        close(listener);
+        return -1;
+    }
+    return listener;
 }
 
 /**
- * Attempts to read the next available time from stdin, in the format HH:MMcc,
- * where HH is the hour, MM is the minute, and cc is the meridiem indicator
- * ("am" or "pm").
+ * Reads every request available from a client and answers each complete one,
+ * the same way batch mode answers a line. Stops early if too many answers are
+ * waiting to be sent.
  *
- * @param hour     A pointer to the int storing the hour for this time.
- * @param minute   A pointer to the int storing the minute for this time.
- * @param meridiem A pointer to the char storing the meridiem indicator for this
- *                 time.
+ * @param client The client to read from.
  *
- * @return 0 if a valid time was read, -1 if something wasn't right with the
- *         read time.
+ * @return 0 if everything available was read, -1 if the connection failed.
  */
-int readTime(int *hour, int *minute, char *meridiem) {
-    // Scan the time in.
-    scanf_s(" %d : %d %c", hour, minute, meridiem);
+int readServeRequests(struct ServeClient *client) {
+    // Until the client has nothing more for us, or we have too much for it...
+    while (client->answers.length - client->sent < SERVE_PENDING_LIMIT) {
+        /**
+         * The number of bytes read.
+         */
+        ssize_t bytesRead = recv(client->socket,
+                                 client->requests + client->requestLength,
+                                 SERVE_LINE_SIZE - client->requestLength, 0);
 
-    // It's a lot easier if we just convert uppercase to lowercase.
-    if (*meridiem == 'A') {
-        *meridiem = 'a';
-    } else if (*meridiem == 'P') {
-        *meridiem = 'p';
-    }
+        /**
+         * The start of the next request to answer.
+         */
+        const char *cursor = client->requests;
 
-    // If we got what looks like a valid time, return 0.
-    if (*hour > 0 && *hour < 13 && *minute > -1 && *minute < 60 &&
-        (*meridiem == 'a' || *meridiem == 'p')) {
-        return 0;
-        // Else...
-    } else {
-        // Print a message explaining what was wrong, return -1.
-        if (*hour <= 0) {
-            printf_s("[ERROR]\tHOUR TOO SMALL: \"%d\", should be "
-                     "greater than 0.\n", *hour);
+        /**
+         * The end of the requests read so far.
+         */
+        const char *end;
+
+        /**
+         * The newline ending the next request.
+         */
+        const char *newline;
+
+        // Once the client is done, answer a last request with no newline.
+        if (bytesRead == 0) {
+            if (client->requestLength > 0 && !client->discarding) {
+                client->handler(client->requests,
+                                client->requests + client->requestLength,
+                                &client->answers);
+            }
+            client->finished = 1;
+            return 0;
         }
-        if (*hour >= 13) {
-            printf_s("[ERROR]\tHOUR TOO BIG: \"%d\", should be less "
-                     "than 13.\n", *hour);
+        if (bytesRead == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
         }
-        if (*minute <= -1) {
-            printf_s("[ERROR]\tMINUTE TOO SMALL: \"%d\", should be "
-                     "greater than -1.\n", *minute);
+        client->requestLength += (size_t) bytesRead;
+        end = client->requests + client->requestLength;
+
+        // Answer every complete request, in order.
+        while ((newline = memchr(cursor, '\n', end - cursor)) != NULL) {
+            if (client->discarding) {
+                client->discarding = 0;
+            } else {
+                client->handler(cursor, newline, &client->answers);
+            }
+            cursor = newline + 1;
         }
-        if (*minute >= 60) {
-            printf_s("[ERROR]\tMINUTE TOO BIG: \"%d\", should be less "
-                     "than 60.\n", *minute);
+
+        // Keep the incomplete request for next time, unless it can't fit.
+        if (!client->discarding && end - cursor == SERVE_LINE_SIZE) {
+            client->handler(NULL, NULL, &client->answers);
+            client->discarding = 1;
         }
-        if ((*meridiem != (int) 'a') && (*meridiem != (int) 'p')) {
-            printf_s("[ERROR]\tUNRECOGNIZED MERIDIEM: \"%cm\", should "
-                     "be \"am\" or \"pm\".\n", *meridiem);
+        if (client->discarding) {
+            cursor = end;
         }
-        return -1;
+        client->requestLength = (size_t) (end - cursor);
+        memmove(client->requests, cursor, client->requestLength);
     }
+    return 0;
 }
 
 /**
- * Converts 12-hour time to 24-hour time, because it is easier to do math with.
+ * Sends a client as many of its waiting answers as it will take right now.
+ *
+ * @param client The client to send to.
  *
- * @param hour     A pointer to the int storing the hour for the time to
- *                 convert.
- * @param meridiem A pointer to the char storing the meridiem indicator for the
- *                 time to convert.
+ * @return 0 if the connection is still fine, -1 if it failed.
  */
-void toMilitaryTime(int *hour, const char *meridiem) {
-    // If it's the 12th hour...
-    if (*hour == 12) {
-        // ...and the am, add 12 so 12am = 24:00/00:00.
-        if (*meridiem == 'a') {
-            *hour += 12;
-        }
-        // Else...
-    } else {
-        // ...if it's the pm, add 12.
-        if (*meridiem == 'p') {
-            *hour += 12;
+int sendServeAnswers(struct ServeClient *client) {
+    while (client->sent < client->answers.length) {
+        /**
+         * The number of bytes sent.
+         */
+        ssize_t bytesSent = send(client->socket,
+                                 client->answers.data + client->sent,
+                                 client->answers.length - client->sent,
+                                 MSG_NOSIGNAL);
+
+        if (bytesSent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return -1;
+            }
+
+            // Keep the buffer from creeping along while the client catches up.
+            if (client->sent >= client->answers.capacity / 2) {
+                memmove(client->answers.data,
+                        client->answers.data + client->sent,
+                        client->answers.length - client->sent);
+                client->answers.length -= client->sent;
+                client->sent = 0;
+            }
+            return 0;
         }
+        client->sent += (size_t) bytesSent;
     }
+    client->answers.length = 0;
+    client->sent           = 0;
+    return 0;
 }
 
 /**
- * Rounds the time difference to the nearest quarter-hour.
+ * Waits for whatever a client needs next: more requests, unless it has
+ * finished sending them or has too many answers waiting, and room to send
+ * answers, if any are waiting.
  *
- * @param hourDifference   A pointer to the integer storing the hour portion of
- *                         the time spent working.
- * @param minuteDifference A pointer to the integer storing the minutes portion
- *                         of the time spent working.
+ * @param epoll  The epoll instance watching the client.
+ * @param client The client to watch.
+ *
+ * @return 0 if the client is being watched, -1 if it could not be.
  */
-void roundTime(int *hourDifference, int *minuteDifference) {
-    // Round the minutes worked to the nearest multiple of 15.
-    *minuteDifference = ((*minuteDifference + 7) / 15) * 15;
+int watchServeClient(int epoll, struct ServeClient *client) {
+    /**
+     * The number of bytes of answers waiting to be sent.
+     */
+    size_t pending = client->answers.length - client->sent;
+
+    /**
+     * The events to wait for.
+     */
+    struct epoll_event event = {
+            .events   = (!client->finished && pending < SERVE_PENDING_LIMIT ?
+                         EPOLLIN : 0) | (pending > 0 ? EPOLLOUT : 0),
+            .data.ptr = client};
 
-    // If rounded to 60 minutes, reset to 0 and increment hours worked.
-    if (*minuteDifference == 60) {
-        *minuteDifference = 0;
-        (*hourDifference)++;
+    if (event.events == client->events) {
+        return 0;
     }
+    client->events = event.events;
+    return epoll_ctl(epoll, EPOLL_CTL_MOD, client->socket, &event);
 }
 
 /**
- * Reads an unspecified number of work start and end times separated by commas.
- * Calculates the time between each and adds that time to the total being
- * tracked for the day.
+ * Disconnects a client and frees everything kept for it.
  *
- * @param totalHours   A pointer to the int storing the total hours worked for
- *                     the day.
- * @param totalMinutes A pointer to the int storing the total minutes worked for
- *                     the day in excess of an hour.
- *
- * @return 1 if all times were successfully read, 0 if a time indicating the
- * program should end was read, -1 if there was an issue reading any of the
- * times.
+ * @param client The client to disconnect.
  */
-int readTimesForDay(int *totalHours, int *totalMinutes) {
-    /**
-     * The return value of clearBufferJunk().
-     */
-    int endFound = 0;
+void closeServeClient(struct ServeClient *client) {
+    close(client->socket);
+    free(client->answers.data);
+    free(client);
+}
 
-    // While we haven't hit the EOF or a newline...
-    while (endFound != 1 && endFound != -1) {
-        // Declare our variables...
+/**
+ * Accepts every client waiting to connect, and starts watching each for
+ * requests.
+ *
+ * @param epoll    The epoll instance to watch the clients with.
+ * @param listener The socket clients connect to.
+ * @param rounding How to round the totals sent back to each client.
+ */
+void acceptServeClients(int epoll, int listener,
+                        const struct Rounding *rounding) {
+    // Until nobody else is waiting...
+    while (1) {
         /**
-         * The hour work was started at (12-hour time).
+         * The socket connected to the new client.
          */
-        int startHour;
+        int socket = accept(listener, NULL, NULL);
 
         /**
-         * The minute work was started at.
+         * Everything kept for the new client.
          */
-        int startMinute;
+        struct ServeClient *client;
 
         /**
-         * The first character of the meridiem indicator for the time work was
-         * started at ('a' or 'p').
+         * The events to wait for from the new client.
          */
-        char startMeridiem;
+        struct epoll_event event = {.events = EPOLLIN};
 
-        /**
-         * The hour work ended at (12-hour time).
-         */
-        int endHour;
+        if (socket == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;
+        }
+        client = calloc(1, sizeof(*client));
+        if (client == NULL ||
+            fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == -1 ||
+            outputOpen(&client->answers, NULL, SERVE_LINE_SIZE) == -1) {
+            free(client);
+            close(socket);
+            continue;
+        }
+        client->answers.rounding = *rounding;
+        client->handler          = findBatchLineHandler(rounding, 0);
+        client->socket           = socket;
+        client->events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, socket, &event) == -1) {
+            closeServeClient(client);
+        }
+    }
+}
+#endif
 
-        /**
-         * The minute work ended at.
-         */
-        int endMinute;
+/**
+ * Runs PUNCHCARD as a server on a Unix domain socket, so other programs can
+ * have days of times summed without starting a new process each time. Each
+ * client sends lines of times in the same format batch mode reads, and gets
+ * back the same result line batch mode writes for each, in order. Clients may
+ * send as many lines as they like without waiting for the answers.
+ *
+ * @param path     The path of the socket to listen at.
+ * @param rounding How to round the totals sent back.
+ *
+ * @return 1, since the server only stops if something goes wrong.
+ */
+int runServe(const char *path, const struct Rounding *rounding) {
+#if defined(PUNCHCARD_SERVE)
+    /**
+     * The socket clients connect to.
+     */
+    int listener = openServeSocket(path);
 
-        /**
-         * The first character of the meridiem indicator for the time work
-         * ended at ('a' or 'p').
-         */
-        char endMeridiem;
+    /**
+     * The epoll instance watching the listener and every client.
+     */
+    int epoll;
 
-        /**
-         * The hour value of the difference between the end time and start time.
-         */
-        int hourDifference;
+    /**
+     * The events to wait for on the listener.
+     */
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+
+    /**
+     * The events that happened since the last wait.
+     */
+    struct epoll_event events[SERVE_MAX_EVENTS];
 
+    if (listener == -1) {
+        printError("[ERROR]\tCOULD NOT LISTEN AT \"", path, "\".\n");
+        return 1;
+    }
+    epoll = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll == -1 ||
+        epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) == -1) {
+        printError("[ERROR]\tCOULD NOT WAIT FOR CLIENTS.\n", NULL, NULL);
+        close(listener);
+        return 1;
+    }
+
+    // Answer clients until something goes wrong.
+    while (1) {
         /**
-         * The minute value of the difference between the end time and start
-         * time.
+         * The number of events that happened.
          */
-        int minuteDifference;
+        int ready = epoll_wait(epoll, events, SERVE_MAX_EVENTS, -1);
 
-        // Read the start time. If something went wrong...
-        if (readTime(&startHour, &startMinute, &startMeridiem) == -1) {
-            // Clean the buffer and try again.
-            printf_s("Something was wrong with your given start time!\n");
-            clearBufferJunk('\n');
-            return -1;
+        if (ready == -1) {
+            if (errno == EINTR) {
+                writeRequestedStatistics();
+                continue;
+            }
+            break;
         }
+        for (int i = 0; i < ready; i++) {
+            /**
+             * The client the event happened to, or NULL for the listener.
+             */
+            struct ServeClient *client = events[i].data.ptr;
 
-        // Skip anything particularly annoying between the two times.
-        clearBufferJunk('-');
+            if (client == NULL) {
+                acceptServeClients(epoll, listener, rounding);
+                continue;
+            }
 
-        // Read the end time. If something went wrong...
-        if (readTime(&endHour, &endMinute, &endMeridiem) == -1) {
-            // Clean the buffer and try again.
-            printf_s("Something was wrong with your given end time!\n");
-            clearBufferJunk('\n');
-            return -1;
+            // Answer whatever the client sent, send back whatever it'll take,
+            // and hang up once it has nothing more to say or hear.
+            if (((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 &&
+                 !client->finished && readServeRequests(client) == -1) ||
+                sendServeAnswers(client) == -1 ||
+                (client->finished && client->answers.length == 0) ||
+                watchServeClient(epoll, client) == -1) {
+                closeServeClient(client);
+            }
         }
+    }
 
-        // Print the times read back, for confirmation/debugging reasons.
-        printf_s("\n");
-        printf_s("START:\t%02d:%02d%cm\n", startHour, startMinute,
-                 startMeridiem);
-        printf_s("END:\t%02d:%02d%cm\n", endHour, endMinute, endMeridiem);
+    printError("[ERROR]\tCOULD NOT WAIT FOR CLIENTS.\n", NULL, NULL);
+    close(epoll);
+    close(listener);
+    return 1;
+#else
+    (void) path;
+    (void) rounding;
+    printError("[ERROR]\tSERVE MODE IS ONLY AVAILABLE ON LINUX.\n", NULL, NULL);
+    return 1;
+#endif
+}
 
-        // If the start time and end time are identical...
-        if (startHour == endHour && startMinute == endMinute && startMeridiem
-                                                                ==
-                                                                endMeridiem) {
-            // Stop the program, we're done here.
-            return 0;
+/**
+ * Finds the rounding policy named on the command line: "quarter" and "tenth"
+ * for the nearest quarter or tenth of an hour, and "quarter-down" and
+ * "tenth-down" to always round down to one.
+ *
+ * @param name The name of the rounding policy.
+ *
+ * @return The enum RoundingPolicy named, or -1 if there is no policy by that
+ *         name.
+ */
+int findNamedRounding(const char *name) {
+    for (size_t i = 0; i < sizeof(roundingNames) / sizeof(roundingNames[0]);
+         i++) {
+        if (strcmp(name, roundingNames[i]) == 0) {
+            return (int) i;
         }
+    }
+    return -1;
+}
+
+// The benchmarks include this file for the batch mode functions above, and
+// bring their own main().
+#ifndef PUNCHCARD_NO_MAIN
+/**
+ * Gives the user a brief introduction, then prompts the user to enter their
+ * start and end times. Calculates the hours worked, and presents the actual
+ * work time as well as the rounded hours format. Repeats this process starting
+ * from prompting the user until the program is stopped in some way or the user
+ * enters the exact same start and end time.
+ *
+ * If run as "PUNCHCARD --batch FILE", instead processes every line of FILE as
+ * one day of times and prints the results without any prompting, optionally
+ * spread across the number of threads given with "--threads N". FILE may also
+ * be a binary punch file, as written by "PUNCHCARD convert FILE BINARY_FILE".
+ * With "--merge-overlaps", time covered by more than one interval on a line is
+ * counted only once, and how much was is printed after the result.
+ *
+ * In every mode, "--rounding POLICY" rounds to the nearest tenth of an hour
+ * instead of quarter-hour with "tenth", and always down with "quarter-down" or
+ * "tenth-down". With "--round-intervals", each interval is rounded before the
+ * day's intervals are added up, outside of aggregate mode.
+ *
+ * If run as "PUNCHCARD index build FILE INDEX", instead reads FILE the same way
+ * aggregate mode does and writes a range index of it to INDEX. Then
+ * "PUNCHCARD index query INDEX EMPLOYEE FROM TO" prints the time EMPLOYEE
+ * worked from the date FROM to the date TO, inclusive, straight from INDEX.
+ *
+ * If run as "PUNCHCARD --serve SOCKET", instead answers lines of times sent to
+ * the Unix domain socket SOCKET the same way batch mode would.
+ *
+ * If run as "PUNCHCARD --aggregate FILE", instead reads lines of
+ * "EMPLOYEE DATE TIMES" from FILE, and prints the total time each employee
+ * worked on each date, sorted by employee and date. With "--rollup", each
+ * week and pay period is totalled as well, along with the overtime in it.
+ * With "--follow", then keeps printing the new totals for whatever employees
+ * and dates change as lines are added to FILE. With "--checkpoint CHECKPOINT",
+ * saves its progress to CHECKPOINT every so often, and carries on from there
+ * if stopped and run again. "--merge-overlaps" works here too, warning about
+ * each line with overlapping times.
+ */
+int main(int argc, char *argv[]) {
+    /**
+     * The file to process in batch mode, if any.
+     */
+    const char *batchPath = NULL;
+
+    /**
+     * The socket to answer clients at in serve mode, if any.
+     */
+    const char *servePath = NULL;
 
-        // Convert both times to 24-hour time.
-        toMilitaryTime(&startHour, &startMeridiem);
-        toMilitaryTime(&endHour, &endMeridiem);
+    /**
+     * The file to aggregate by employee and date, if any.
+     */
+    const char *aggregatePath = NULL;
 
-        // Calculate the difference
-        hourDifference   = endHour - startHour;
-        minuteDifference = endMinute - startMinute;
+    /**
+     * How to roll aggregated days up into weeks and pay periods.
+     */
+    struct RollupPolicy policy = {
+            .dailyOvertime  = ROLLUP_DAILY_OVERTIME * 60,
+            .weeklyOvertime = ROLLUP_WEEKLY_OVERTIME * 60,
+            .periodStart    = ROLLUP_PERIOD_START,
+            .periodWeeks    = ROLLUP_PERIOD_WEEKS};
 
-        // If the minutes are less than 0...
-        if (minuteDifference < 0) {
-            // Tick down an hour and set the minutes to the correct value.
-            hourDifference--;
-            minuteDifference += 60;
-        }
+    /**
+     * Whether aggregated days should be rolled up.
+     */
+    int rollup = 0;
 
-        // If the hour is less than 0...
-        if (hourDifference < 0) {
-            // Add 24 to find the actual hour.
-            hourDifference += 24;
-        }
+    /**
+     * Whether to keep reading lines added to the aggregated file.
+     */
+    int follow = 0;
+
+    /**
+     * Whether to count time covered by more than one interval only once.
+     */
+    int mergeOverlaps = 0;
+
+    /**
+     * How to round the totals for each day.
+     */
+    struct Rounding rounding = {ROUND_QUARTER_HOUR, 0};
+
+    /**
+     * The file to save aggregate progress in, if any.
+     */
+    const char *checkpointPath = NULL;
+
+    /**
+     * The seconds between saving aggregate progress.
+     */
+    int checkpointSeconds = CHECKPOINT_SECONDS;
+
+    /**
+     * Where and how often to save aggregate progress.
+     */
+    struct Checkpoint checkpoint;
+
+    /**
+     * The number of threads to use in batch mode.
+     */
+    int threadCount = 1;
+
+    /**
+     * Whether only the totals for each day should be printed.
+     */
+    int quiet = 0;
+
+    /**
+     * Whether to report the statistics kept on exit and when signalled.
+     */
+    int reportStatistics = 0;
+
+    /**
+     * Whether to skip only the fields of a line that can't be read, rather
+     * than the whole line.
+     */
+    int recover = 0;
+
+    /**
+     * Everything printed to stdout, collected so it can be written out in
+     * large pieces.
+     */
+    struct OutputBuffer output;
+
+    /**
+     * Everything typed in at the prompt, read in as large pieces as are
+     * available.
+     */
+    struct InputBuffer input = {.file = ioStandardInput()};
+
+    /**
+     * The value to exit with.
+     */
+    int status = 0;
 
-        // Add to the total for today.
-        *totalMinutes += minuteDifference;
-        *totalHours += hourDifference;
+    /**
+     * The file to convert to a binary punch file and the file to write it to,
+     * if any.
+     */
+    const char *convertPaths[2] = {NULL, NULL};
+
+    /**
+     * The file to build a range index from and the index to write, if any.
+     */
+    const char *indexPaths[2] = {NULL, NULL};
+
+    /**
+     * The range index to query, followed by the employee and the first and
+     * last dates to ask about, if any.
+     */
+    const char *indexQuery[4] = {NULL, NULL, NULL, NULL};
 
-        // If we have enough minutes saved for an hour, convert to an hour.
-        if (*totalMinutes >= 60) {
-            *totalMinutes -= 60;
-            *totalHours += 1;
+    // Read the command and options given.
+    statistics.started = readClock();
+    if (argc >= 4 && strcmp(argv[1], "convert") == 0) {
+        convertPaths[0] = argv[2];
+        convertPaths[1] = argv[3];
+        argc -= 3;
+        argv += 3;
+    } else if (argc >= 5 && strcmp(argv[1], "index") == 0 &&
+               strcmp(argv[2], "build") == 0) {
+        indexPaths[0] = argv[3];
+        indexPaths[1] = argv[4];
+        argc -= 4;
+        argv += 4;
+    } else if (argc >= 7 && strcmp(argv[1], "index") == 0 &&
+               strcmp(argv[2], "query") == 0) {
+        memcpy(indexQuery, argv + 3, sizeof(indexQuery));
+        argc -= 6;
+        argv += 6;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            servePath = argv[++i];
+        } else if (strcmp(argv[i], "--aggregate") == 0 && i + 1 < argc) {
+            aggregatePath = argv[++i];
+        } else if (strcmp(argv[i], "--rollup") == 0) {
+            rollup = 1;
+        } else if (strcmp(argv[i], "--follow") == 0) {
+            follow = 1;
+        } else if (strcmp(argv[i], "--merge-overlaps") == 0) {
+            mergeOverlaps = 1;
+        } else if (strcmp(argv[i], "--rounding") == 0 && i + 1 < argc) {
+            /**
+             * The rounding policy named, or -1 if there is none by that name.
+             */
+            int named = findNamedRounding(argv[++i]);
+
+            if (named == -1) {
+                printError("[ERROR]\tUNKNOWN ROUNDING: \"", argv[i],
+                           "\", should be quarter, quarter-down, tenth, or "
+                           "tenth-down.\n");
+                return 1;
+            }
+            rounding.policy = (enum RoundingPolicy) named;
+        } else if (strcmp(argv[i], "--round-intervals") == 0) {
+            rounding.perInterval = 1;
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-seconds") == 0 &&
+                   i + 1 < argc) {
+            checkpointSeconds = atoi(argv[++i]);
+            if (checkpointSeconds < 0) {
+                printError("[ERROR]\tCHECKPOINT SECONDS OUT OF RANGE: \"",
+                           argv[i], "\", should be 0 or more.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--daily-overtime") == 0 && i + 1 < argc) {
+            policy.dailyOvertime = atoi(argv[++i]) * 60;
+            if (policy.dailyOvertime < 0 ||
+                policy.dailyOvertime > MINUTES_PER_DAY) {
+                printError("[ERROR]\tDAILY OVERTIME OUT OF RANGE: \"", argv[i],
+                           "\", should be from 0 to 24 hours.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--weekly-overtime") == 0 &&
+                   i + 1 < argc) {
+            policy.weeklyOvertime = atoi(argv[++i]) * 60;
+            if (policy.weeklyOvertime < 0 ||
+                policy.weeklyOvertime > 7 * MINUTES_PER_DAY) {
+                printError("[ERROR]\tWEEKLY OVERTIME OUT OF RANGE: \"",
+                           argv[i], "\", should be from 0 to 168 hours.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--pay-period-start") == 0 &&
+                   i + 1 < argc) {
+            /**
+             * The position in the date being read.
+             */
+            const char *cursor = argv[++i];
+
+            if (parseDate(&cursor, cursor + strlen(cursor),
+                          &policy.periodStart) == -1 || *cursor != '\0') {
+                printError("[ERROR]\tPAY PERIOD START NOT A DATE: \"", argv[i],
+                           "\", should be YYYY-MM-DD.\n");
+                return 1;
+            }
+            policy.periodStart = startOfWeek(policy.periodStart);
+        } else if (strcmp(argv[i], "--pay-period-weeks") == 0 &&
+                   i + 1 < argc) {
+            policy.periodWeeks = atoi(argv[++i]);
+            if (policy.periodWeeks < 1 ||
+                policy.periodWeeks > ROLLUP_MAX_PERIOD_WEEKS) {
+                printError("[ERROR]\tPAY PERIOD OUT OF RANGE: \"", argv[i],
+                           "\", should be from 1 to "
+                           VALUE_STRING(ROLLUP_MAX_PERIOD_WEEKS) " weeks.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            reportStatistics = 1;
+        } else if (strcmp(argv[i], "--recover") == 0) {
+            recover = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+            if (threadCount < 1 || threadCount > BATCH_MAX_THREADS) {
+                printError("[ERROR]\tTHREAD COUNT OUT OF RANGE: \"", argv[i],
+                           "\", should be from 1 to "
+                           VALUE_STRING(BATCH_MAX_THREADS) ".\n");
+                return 1;
+            }
+        } else {
+            printError("Usage: PUNCHCARD [--quiet] [--batch FILE] "
+                       "[--threads N] [--merge-overlaps]\n"
+                       "                 [--rounding POLICY] "
+                       "[--round-intervals] [--recover] [--stats]\n"
+                       "       PUNCHCARD convert FILE BINARY_FILE "
+                       "[--threads N]\n"
+                       "       PUNCHCARD index build FILE INDEX "
+                       "[--merge-overlaps] [--rounding POLICY]\n"
+                       "                 [--recover]\n"
+                       "       PUNCHCARD index query INDEX EMPLOYEE FROM TO\n"
+                       "       PUNCHCARD --serve SOCKET [--rounding POLICY] "
+                       "[--round-intervals]\n"
+                       "       PUNCHCARD --aggregate FILE [--follow] "
+                       "[--rollup] [--daily-overtime HOURS]\n"
+                       "                 [--weekly-overtime HOURS] "
+                       "[--pay-period-start DATE]\n"
+                       "                 [--pay-period-weeks N] "
+                       "[--checkpoint FILE]\n"
+                       "                 [--checkpoint-seconds N] "
+                       "[--merge-overlaps] [--rounding POLICY]\n"
+                       "                 [--recover]\n",
+                       NULL, NULL);
+            return 1;
         }
+    }
 
-        // Print the time worked.
-        printf_s("ACTUAL TIME:\t%02d hours and %02d minutes.\n", hourDifference,
-                 minuteDifference);
+    // If asked to, report the statistics on exit, and whenever signalled to.
+    if (reportStatistics) {
+        atexit(writeStatistics);
+#if defined(SIGUSR1)
+        // Without SA_RESTART, so a wait for more input is cut short to report.
+        sigaction(SIGUSR1,
+                  &(struct sigaction) {.sa_handler = requestStatistics},
+                  NULL);
+#endif
+    }
 
-        // Move to the next time if possible.
-        endFound = clearBufferJunk(',');
+    // If asked to, convert a file to a binary punch file.
+    if (convertPaths[0] != NULL) {
+        return runConvert(convertPaths[0], convertPaths[1], threadCount);
+    }
+
+    // If asked to, build a range index.
+    if (indexPaths[0] != NULL) {
+        return runIndexBuild(indexPaths[0], indexPaths[1], mergeOverlaps,
+                             recover, &rounding);
+    }
+
+    // If asked to, answer clients on a socket until stopped.
+    if (servePath != NULL) {
+        return runServe(servePath, &rounding);
+    }
+
+    // Set aside room to collect output in.
+    if (outputOpen(&output, ioStandardOutput(), OUTPUT_BUFFER_SIZE) == -1) {
+        printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+        return 1;
+    }
+    output.quiet    = quiet;
+    output.rounding = rounding;
+    output.recover  = recover;
+
+    // If asked to, look up a total in a range index.
+    if (indexQuery[0] != NULL) {
+        status = runIndexQuery(indexQuery[0], indexQuery[1], indexQuery[2],
+                               indexQuery[3], &output);
+        outputClose(&output);
+        return status;
+    }
+
+    // If asked to, process a whole file at once instead.
+    if (batchPath != NULL) {
+        status = runBatchFile(batchPath, threadCount, mergeOverlaps,
+                              &output);
+        outputClose(&output);
+        return status;
+    }
+
+    // If asked to, total up a file of times by employee and date.
+    if (aggregatePath != NULL) {
+        if (checkpointPath != NULL && follow) {
+            printError("[ERROR]\tCHECKPOINTS CAN'T BE USED WHILE FOLLOWING A "
+                       "FILE.\n", NULL, NULL);
+            status = 1;
+        } else if (checkpointPath != NULL &&
+                   openCheckpoint(&checkpoint, checkpointPath,
+                                  checkpointSeconds) == -1) {
+            printError("[ERROR]\tOUT OF MEMORY.\n", NULL, NULL);
+            status = 1;
+        } else {
+            status = runAggregate(aggregatePath, rollup ? &policy : NULL,
+                                  follow, mergeOverlaps,
+                                  checkpointPath != NULL ? &checkpoint : NULL,
+                                  &output);
+            if (checkpointPath != NULL) {
+                closeCheckpoint(&checkpoint);
+            }
+        }
+        outputClose(&output);
+        return status;
     }
-    return 1;
-}
 
-/**
- * Gives the user a brief introduction, then prompts the user to enter their
- * start and end times. Calculates the hours worked, and presents the actual
- * work time as well as the rounded hours format. Repeats this process starting
- * from prompting the user until the program is stopped in some way or the user
- * enters the exact same start and end time.
- */
-int main(void) {
     // Introduction
-    printf_s("Welcome to PUNCHCARD! This program is meant to help you record "
-             "your work hours\nas an employee. To get started, just enter your "
-             "start time and end time, in the\nformat HH:MMcc-HH:MMcc. For "
-             "example, if you worked from noon to 3pm today, you'd\nenter "
-             "12:00pm-3:00pm. You can enter multiple times like this separated "
-             "by\ncommas, just make sure they're all for the same day. They "
-             "will first be summed,\nthen rounded. You can quit the program by "
-             "closing this window, pressing Ctrl +\nC, or entering a start time"
-             " and end time that are identical (such as 1:00pm-\n1:00pm).\n\n");
+    if (!output.quiet) {
+        outputString(&output,
+                     "Welcome to PUNCHCARD! This program is meant to help you "
+                     "record your work hours\nas an employee. To get started, "
+                     "just enter your start time and end time, in the\nformat "
+                     "HH:MMcc-HH:MMcc. For example, if you worked from noon to "
+                     "3pm today, you'd\nenter 12:00pm-3:00pm. You can enter "
+                     "multiple times like this separated by\ncommas, just make "
+                     "sure they're all for the same day. They will first be "
+                     "summed,\nthen rounded. You can quit the program by "
+                     "closing this window, pressing Ctrl +\nC, or entering a "
+                     "start time and end time that are identical (such as "
+                     "1:00pm-\n1:00pm).\n\n");
+    }
 
     /**
      * Whether or not to continue running.
@@ -332,25 +7241,24 @@ int main(void) {
     // Until given a reason to stop...
     while (continueRunning) {
         /**
-         * The time spent working in hours, rounded to the nearest quarter-hour.
-         */
-        float roundedTime;
-
-        /**
-         * The total hours worked this day.
+         * The total minutes worked this day.
          */
-        int totalHours = 0;
+        int totalMinutes = 0;
 
         /**
-         * The total minutes worked this day excess of an hour.
+         * The total of each interval worked this day, rounded on its own.
          */
-        int totalMinutes = 0;
+        int roundedMinutes = 0;
 
         // Prompt the user.
-        printf_s("Enter your times for today separated by commas:\n");
+        if (!output.quiet) {
+            outputString(&output,
+                         "Enter your times for today separated by commas:\n");
+        }
 
         // Read and sum the times worked for today
-        continueRunning = readTimesForDay(&totalHours, &totalMinutes);
+        continueRunning = readTimesForDay(&totalMinutes, &roundedMinutes,
+                                          &input, &output);
 
         // If we had issues reading one of the times, try again.
         if (continueRunning == -1) {
@@ -359,16 +7267,29 @@ int main(void) {
         }
 
         // Print the time worked for the day.
-        printf_s("\n\nACTUAL TOTAL TIME:\t%02d hours and %02d minutes.\n",
-                 totalHours,
-                 totalMinutes);
+        if (!output.quiet) {
+            outputString(&output, "\n\n");
+        }
+        outputString(&output, "ACTUAL TOTAL TIME:\t");
+        outputNumber(&output, totalMinutes / 60, 2);
+        outputString(&output, " hours and ");
+        outputNumber(&output, totalMinutes % 60, 2);
+        outputString(&output, " minutes.\n");
 
-        // Round to the nearest quarter-hour and print.
-        roundTime(&totalHours, &totalMinutes);
-        roundedTime = ((float) totalMinutes / 60) + (float) totalHours;
-        printf_s("ROUNDED TOTAL TIME:\t%0.2f hours.\n\n", roundedTime);
+        // Round the day, unless every interval was rounded already, and print.
+        if (!output.rounding.perInterval) {
+            roundedMinutes = roundMinutes(&output.rounding, totalMinutes);
+        }
+        outputString(&output, "ROUNDED TOTAL TIME:\t");
+        outputHours(&output, roundedMinutes);
+        outputString(&output, " hours.\n");
+        if (!output.quiet) {
+            outputChar(&output, '\n');
+        }
     }
 
     // Finish the program.
+    outputClose(&output);
     return 0;
 }
+#endif
@@ -0,0 +1,1001 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details Benchmarks for the parsing and rounding hot paths of PUNCHCARD. A
+ * synthetic punch log is generated from the options given, then each hot path
+ * is timed over it, along with whole batch runs over the log as text and as
+ * binary punch records. Every result is printed as a single line of JSON, so
+ * results can be collected and compared across releases.
+ *
+ * Options:
+ *   --lines N        The number of days in the generated log (default 1000000).
+ *   --intervals N    The number of intervals on each day (default 3).
+ *   --error-rate R   The fraction of days with an unreadable time (default
+ *                    0.01).
+ *   --seed N         The seed for the generator (default 1).
+ *   --threads N      The number of threads for the whole batch runs (default
+ *                    1).
+ *   --generate FILE  Write the generated log to FILE and stop, so it can be
+ *                    fed to PUNCHCARD itself.
+ *   --serve SOCKET   Instead of the other benchmarks, time a PUNCHCARD already
+ *                    running with "--serve SOCKET" answering the log, a line
+ *                    at a time and then all at once.
+ */
+
+// The front end, for whole batch runs, which brings libpunchcard in with it for
+// everything else.
+#define PUNCHCARD_NO_MAIN
+#include "../PUNCHCARD.c"
+
+// Libraries in use:
+#include <stdio.h>
+#include <time.h>
+
+// Constants
+/**
+ * A file that throws away everything written to it, for timing output alone.
+ */
+#if defined(_WIN32)
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+// Types
+/**
+ * The settings for a benchmark run.
+ */
+struct BenchSettings {
+    /**
+     * The number of days in the generated log.
+     */
+    long lines;
+
+    /**
+     * The number of intervals on each day.
+     */
+    int intervals;
+
+    /**
+     * The fraction of days with an unreadable time.
+     */
+    double errorRate;
+
+    /**
+     * The seed for the generator.
+     */
+    uint64_t seed;
+
+    /**
+     * The number of threads for the whole batch runs.
+     */
+    int threadCount;
+};
+
+// Functions
+/**
+ * Produces the next number from a xorshift64* generator, so logs are the same
+ * from run to run and platform to platform.
+ *
+ * @param state A pointer to the generator's state, which must not be 0.
+ *
+ * @return The next pseudo-random number.
+ */
+uint64_t nextRandom(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * Reads the current time in seconds, from a monotonic clock where available.
+ *
+ * @return The current time in seconds.
+ */
+double now(void) {
+    /**
+     * The current time.
+     */
+    struct timespec time;
+
+#if defined(TIME_MONOTONIC)
+    timespec_get(&time, TIME_MONOTONIC);
+#else
+    timespec_get(&time, TIME_UTC);
+#endif
+    return (double) time.tv_sec + (double) time.tv_nsec / 1e9;
+}
+
+/**
+ * Generates a synthetic punch log: one day per line, each a comma separated
+ * list of intervals, with some days broken by an unreadable time.
+ *
+ * @param settings The settings describing the log to generate.
+ * @param log      The output buffer to write the log to.
+ */
+void generateLog(const struct BenchSettings *settings,
+                 struct OutputBuffer *log) {
+    /**
+     * The state of the generator.
+     */
+    uint64_t state = settings->seed == 0 ? 1 : settings->seed;
+
+    for (long line = 0; line < settings->lines; line++) {
+        /**
+         * Which interval on this day, if any, gets an unreadable time.
+         */
+        int broken = (double) (nextRandom(&state) % 1000000) / 1000000 <
+                     settings->errorRate ?
+                     (int) (nextRandom(&state) % settings->intervals) : -1;
+
+        for (int interval = 0; interval < settings->intervals; interval++) {
+            if (interval > 0) {
+                outputString(log, ", ");
+            }
+
+            // Write the start and end times.
+            for (int time = 0; time < 2; time++) {
+                if (time == 1) {
+                    outputChar(log, '-');
+                }
+                if (interval == broken && time == 1) {
+                    outputString(log, "13:75xm");
+                    continue;
+                }
+                outputNumber(log, (int) (nextRandom(&state) % 12) + 1, 1);
+                outputChar(log, ':');
+                outputNumber(log, (int) (nextRandom(&state) % 60), 2);
+                outputString(log, nextRandom(&state) % 2 ? "pm" : "am");
+            }
+        }
+        outputChar(log, '\n');
+    }
+}
+
+/**
+ * Prints the result of a micro-benchmark as a line of JSON.
+ *
+ * @param name       The name of the benchmark.
+ * @param operations The number of operations timed.
+ * @param seconds    The time the operations took.
+ * @param checksum   A value computed from the results, printed so the work
+ *                   can't be optimized away.
+ */
+void reportOperations(const char *name, long long operations, double seconds,
+                      long long checksum) {
+    printf("{\"benchmark\":\"%s\",\"operations\":%lld,\"seconds\":%.6f,"
+           "\"ns_per_op\":%.3f,\"ops_per_sec\":%.0f,\"checksum\":%lld}\n",
+           name, operations, seconds, seconds * 1e9 / (double) operations,
+           (double) operations / seconds, checksum);
+}
+
+/**
+ * Prints the result of a whole batch run as a line of JSON.
+ *
+ * @param name    The name of the benchmark.
+ * @param lines   The number of lines processed.
+ * @param bytes   The number of bytes of input processed.
+ * @param seconds The time processing took.
+ */
+void reportThroughput(const char *name, long lines, size_t bytes,
+                      double seconds) {
+    printf("{\"benchmark\":\"%s\",\"lines\":%ld,\"bytes\":%zu,"
+           "\"seconds\":%.6f,\"lines_per_sec\":%.0f,\"mb_per_sec\":%.2f}\n",
+           name, lines, bytes, seconds, (double) lines / seconds,
+           (double) bytes / seconds / 1e6);
+}
+
+/**
+ * Times parseTime() and, for comparison, the sscanf() format it replaced, over
+ * every time in the log.
+ *
+ * @param begin The first character of the log.
+ * @param end   One past the last character of the log.
+ */
+void benchmarkReadTime(const char *begin, const char *end) {
+    /**
+     * The number of times parsed.
+     */
+    long long count = 0;
+
+    /**
+     * A sum of everything parsed.
+     */
+    long long checksum = 0;
+
+    /**
+     * When timing started.
+     */
+    double start = now();
+
+    int hour;
+    int minute;
+    char meridiem;
+
+    // Parse every time, stepping over the hyphens and commas between them.
+    for (const char *cursor = begin; cursor < end;) {
+        checksum += parseTime(&cursor, end, &hour, &minute, &meridiem) + hour +
+                    minute;
+        count++;
+        while (cursor < end && *cursor != '-' && *cursor != ',' &&
+               *cursor != '\n') {
+            cursor++;
+        }
+        cursor++;
+    }
+    reportOperations("readTime.parseTime", count, now() - start, checksum);
+
+    // Do the same with sscanf().
+    count    = 0;
+    checksum = 0;
+    start    = now();
+    for (const char *cursor = begin; cursor < end;) {
+        /**
+         * This time on its own, since sscanf() needs a string and would
+         * otherwise measure the length of the whole log every call.
+         */
+        char time[32];
+
+        /**
+         * The length of this time.
+         */
+        size_t length = 0;
+
+        while (cursor + length < end && cursor[length] != '-' &&
+               cursor[length] != ',' && cursor[length] != '\n' &&
+               length < sizeof(time) - 1) {
+            length++;
+        }
+        memcpy(time, cursor, length);
+        time[length] = '\0';
+        if (sscanf(time, " %d : %d %c", &hour, &minute, &meridiem) == 3) {
+            checksum += hour + minute;
+        }
+        count++;
+        cursor += length;
+        while (cursor < end && *cursor != '-' && *cursor != ',' &&
+               *cursor != '\n') {
+            cursor++;
+        }
+        cursor++;
+    }
+    reportOperations("readTime.sscanf", count, now() - start, checksum);
+}
+
+/**
+ * Times skipBufferJunk(), the buffer equivalent of clearBufferJunk(), stepping
+ * from delimiter to delimiter over the whole log.
+ *
+ * @param begin The first character of the log.
+ * @param end   One past the last character of the log.
+ */
+void benchmarkClearBufferJunk(const char *begin, const char *end) {
+    /**
+     * The number of delimiters skipped to.
+     */
+    long long count = 0;
+
+    /**
+     * A sum of the reasons each skip stopped.
+     */
+    long long checksum = 0;
+
+    /**
+     * When timing started.
+     */
+    double start = now();
+
+    for (const char *cursor = begin; cursor < end; count++) {
+        checksum += skipBufferJunk(&cursor, end, count % 2 ? ',' : '-');
+    }
+    reportOperations("clearBufferJunk.skipBufferJunk", count, now() - start,
+                     checksum);
+}
+
+/**
+ * Times toMinutes(), which replaced toMilitaryTime(), and roundTime() over
+ * every possible input, then the rounding function of each policy over the
+ * same totals.
+ *
+ * @param repeats The number of times to go over every input.
+ */
+void benchmarkTimeMath(int repeats) {
+    /**
+     * A sum of every result.
+     */
+    long long checksum = 0;
+
+    /**
+     * When timing started.
+     */
+    double start = now();
+
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int hour = 1; hour <= 12; hour++) {
+            for (int minute = 0; minute < 60; minute++) {
+                checksum += toMinutes(hour, minute, 'a') +
+                            toMinutes(hour, minute, 'p');
+            }
+        }
+    }
+    reportOperations("toMilitaryTime.toMinutes", (long long) repeats * 1440,
+                     now() - start, checksum);
+
+    checksum = 0;
+    start    = now();
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        for (int minutes = 0; minutes < 2 * MINUTES_PER_DAY; minutes++) {
+            /**
+             * The total being rounded.
+             */
+            int total = minutes + repeat % 2;
+
+            roundTime(&total);
+            checksum += total;
+        }
+    }
+    reportOperations("roundTime", (long long) repeats * 2 * MINUTES_PER_DAY,
+                     now() - start, checksum);
+
+    // Round the same totals by each policy, through its own function.
+    for (size_t policy = 0;
+         policy < sizeof(roundingNames) / sizeof(roundingNames[0]); policy++) {
+        /**
+         * The function rounding by the policy.
+         */
+        RoundingFunction round =
+                findRoundingFunction((enum RoundingPolicy) policy);
+
+        /**
+         * The name the result is reported under.
+         */
+        char name[64];
+
+        snprintf(name, sizeof(name), "round.%s", roundingNames[policy]);
+        checksum = 0;
+        start    = now();
+        for (int repeat = 0; repeat < repeats; repeat++) {
+            for (int minutes = 0; minutes < 2 * MINUTES_PER_DAY; minutes++) {
+                checksum += round(minutes + repeat % 2);
+            }
+        }
+        reportOperations(name, (long long) repeats * 2 * MINUTES_PER_DAY,
+                         now() - start, checksum);
+    }
+}
+
+/**
+ * Times a whole batch run over the log as text, and over the same log as
+ * binary punch records, with the totals rounded one way.
+ *
+ * @param settings The settings the log was generated with.
+ * @param begin    The first character of the log.
+ * @param end      One past the last character of the log, just after a
+ *                 newline.
+ * @param records  The log converted to binary punch records.
+ * @param rounding How to round the totals.
+ */
+void benchmarkRoundedBatch(const struct BenchSettings *settings,
+                           const char *begin, const char *end,
+                           const struct OutputBuffer *records,
+                           const struct Rounding *rounding) {
+    /**
+     * The share of the log given to each worker.
+     */
+    struct BatchChunk chunks[BATCH_MAX_THREADS] = {0};
+
+    /**
+     * The results, collected and thrown away a block at a time.
+     */
+    struct OutputBuffer results;
+
+    /**
+     * The names the results are reported under.
+     */
+    char textName[64], binaryName[64];
+
+    /**
+     * When timing started.
+     */
+    double start;
+
+    if (outputOpen(&results, NULL, OUTPUT_BUFFER_SIZE) == -1) {
+        fprintf(stderr, "[ERROR]\tOUT OF MEMORY.\n");
+        return;
+    }
+    results.rounding = *rounding;
+    if (openBatchChunks(chunks, settings->threadCount,
+                        findBatchLineHandler(rounding, 0), &results) == -1) {
+        fprintf(stderr, "[ERROR]\tOUT OF MEMORY.\n");
+        free(results.data);
+        return;
+    }
+    snprintf(textName, sizeof(textName), "batch.text.%s%s",
+             roundingNames[rounding->policy],
+             rounding->perInterval ? ".intervals" : "");
+    snprintf(binaryName, sizeof(binaryName), "batch.binary.%s%s",
+             roundingNames[rounding->policy],
+             rounding->perInterval ? ".intervals" : "");
+
+    // Process the text a block at a time, the same as batch mode does.
+    start = now();
+    for (const char *cursor = begin; cursor < end;) {
+        /**
+         * One past the last complete line in this block.
+         */
+        const char *linesEnd = (size_t) (end - cursor) >
+                               (size_t) BATCH_BLOCK_SIZE *
+                               settings->threadCount ?
+                               cursor + (size_t) BATCH_BLOCK_SIZE *
+                                        settings->threadCount : end;
+
+        while (linesEnd[-1] != '\n') {
+            linesEnd--;
+        }
+        results.length = 0;
+        processBatchBlock(&results, chunks, settings->threadCount, cursor,
+                          linesEnd);
+        cursor = linesEnd;
+    }
+    reportThroughput(textName, settings->lines, (size_t) (end - begin),
+                     now() - start);
+    closeBatchChunks(chunks, settings->threadCount);
+
+    // Process the binary punch records.
+    start = now();
+    for (const char *cursor = records->data;
+         cursor < records->data + records->length;) {
+        /**
+         * The first record not processed this time around.
+         */
+        const char *rest;
+
+        results.length = 0;
+        rest = processBinaryRecords(
+                cursor, (size_t) (records->data + records->length - cursor) >
+                        BATCH_BLOCK_SIZE ? cursor + BATCH_BLOCK_SIZE :
+                        records->data + records->length, 0, &results);
+        if (rest == cursor) {
+            break;
+        }
+        cursor = rest;
+    }
+    reportThroughput(binaryName, settings->lines, records->length,
+                     now() - start);
+
+    free(results.data);
+}
+
+/**
+ * Times converting the log to binary punch records, then whole batch runs over
+ * the log as text and as binary punch records for each rounding policy, with
+ * the day rounded and with each interval rounded, and the results collected in
+ * memory rather than written anywhere.
+ *
+ * @param settings The settings the log was generated with.
+ * @param begin    The first character of the log.
+ * @param end      One past the last character of the log, just after a
+ *                 newline.
+ */
+void benchmarkBatch(const struct BenchSettings *settings, const char *begin,
+                    const char *end) {
+    /**
+     * The share of the log given to each worker.
+     */
+    struct BatchChunk chunks[BATCH_MAX_THREADS] = {0};
+
+    /**
+     * The log converted to binary punch records.
+     */
+    struct OutputBuffer records;
+
+    /**
+     * When timing started.
+     */
+    double start;
+
+    if (outputOpen(&records, NULL, OUTPUT_BUFFER_SIZE) == -1 ||
+        openBatchChunks(chunks, settings->threadCount, convertBatchLine,
+                        &records) == -1) {
+        fprintf(stderr, "[ERROR]\tOUT OF MEMORY.\n");
+        return;
+    }
+
+    // Convert the log to binary punch records.
+    start = now();
+    processBatchBlock(&records, chunks, settings->threadCount, begin, end);
+    reportThroughput("convert", settings->lines, (size_t) (end - begin),
+                     now() - start);
+    closeBatchChunks(chunks, settings->threadCount);
+
+    // Run the batch both ways for every policy, rounding days then intervals.
+    for (int perInterval = 0; perInterval < 2; perInterval++) {
+        for (size_t policy = 0;
+             policy < sizeof(roundingNames) / sizeof(roundingNames[0]);
+             policy++) {
+            /**
+             * How the totals are rounded this run.
+             */
+            struct Rounding rounding = {(enum RoundingPolicy) policy,
+                                        perInterval};
+
+            benchmarkRoundedBatch(settings, begin, end, &records, &rounding);
+        }
+    }
+
+    free(records.data);
+}
+
+/**
+ * Times libpunchcard summing the whole log through sumDaysInBuffer(), with no
+ * output or threads involved, the way a program embedding it would.
+ *
+ * @param settings The settings the log was generated with.
+ * @param begin    The first character of the log.
+ * @param end      One past the last character of the log.
+ */
+void benchmarkLibrary(const struct BenchSettings *settings, const char *begin,
+                      const char *end) {
+    /**
+     * The totals for a batch of days.
+     */
+    struct DayTotal days[1024];
+
+    /**
+     * A sum of every rounded total.
+     */
+    long long checksum = 0;
+
+    /**
+     * When timing started.
+     */
+    double start = now();
+
+    for (const char *cursor = begin; cursor < end;) {
+        /**
+         * The number of days summed this time around.
+         */
+        size_t count = sumDaysInBuffer(cursor, end, days,
+                                       sizeof(days) / sizeof(days[0]), &cursor);
+
+        for (size_t i = 0; i < count; i++) {
+            checksum += days[i].roundedMinutes;
+        }
+    }
+    reportThroughput("library.sumDaysInBuffer", settings->lines,
+                     (size_t) (end - begin), now() - start);
+    (void) checksum;
+}
+
+/**
+ * Times writing the result line for every day in the log to the null device,
+ * once through the output buffer, formatter, and I/O backend batch mode uses,
+ * and once through fprintf() the way PUNCHCARD used to print them.
+ *
+ * @param settings The settings the log was generated with.
+ * @param begin    The first character of the log.
+ * @param end      One past the last character of the log.
+ */
+void benchmarkOutput(const struct BenchSettings *settings, const char *begin,
+                     const char *end) {
+    /**
+     * The totals for every day in the log.
+     */
+    struct DayTotal *days = malloc((size_t) settings->lines * sizeof(*days));
+
+    /**
+     * The number of days in the log.
+     */
+    size_t count;
+
+    /**
+     * The null device, opened through the I/O backend.
+     */
+    struct IoFile *native;
+
+    /**
+     * The null device, opened as a standard C stream.
+     */
+    FILE *stream;
+
+    /**
+     * The results, collected and written out through the I/O backend.
+     */
+    struct OutputBuffer results;
+
+    /**
+     * The number of bytes written each way.
+     */
+    size_t bytes = 0;
+
+    /**
+     * When timing started.
+     */
+    double start;
+
+    native = ioOpenWrite(NULL_DEVICE);
+    stream = fopen(NULL_DEVICE, "wb");
+    if (days == NULL || native == NULL || stream == NULL ||
+        outputOpen(&results, native, OUTPUT_BUFFER_SIZE) == -1) {
+        fprintf(stderr, "[ERROR]\tCOULD NOT OPEN \"%s\".\n", NULL_DEVICE);
+        return;
+    }
+    count = sumDaysInBuffer(begin, end, days, (size_t) settings->lines, NULL);
+
+    // Write through fprintf(), counting the bytes, the same either way.
+    start = now();
+    for (size_t i = 0; i < count; i++) {
+        if (days[i].minutes == -1) {
+            bytes += (size_t) fprintf(stream, "ERROR\n");
+        } else {
+            bytes += (size_t) fprintf(stream, "%02d:%02d\t%0.2f\n",
+                                      days[i].minutes / 60,
+                                      days[i].minutes % 60,
+                                      days[i].roundedMinutes / 60.0);
+        }
+    }
+    fflush(stream);
+    reportThroughput("output.stdio", (long) count, bytes, now() - start);
+
+    // Write through the output buffer and I/O backend instead.
+    start = now();
+    for (size_t i = 0; i < count; i++) {
+        if (days[i].minutes == -1) {
+            outputText(&results, "ERROR\n", 6);
+        } else {
+            outputRoundedDayResult(&results, days[i].minutes,
+                                   days[i].roundedMinutes);
+        }
+    }
+    outputClose(&results);
+    reportThroughput("output.native", (long) count, bytes, now() - start);
+
+    fclose(stream);
+    ioClose(native);
+    free(days);
+}
+
+#if defined(PUNCHCARD_SERVE)
+/**
+ * A connection to a PUNCHCARD in serve mode, along with the requests to send
+ * it, for the thread sending them.
+ */
+struct ServeRequests {
+    /**
+     * The socket connected to the server.
+     */
+    int socket;
+
+    /**
+     * The first character of the requests.
+     */
+    const char *begin;
+
+    /**
+     * One past the last character of the requests.
+     */
+    const char *end;
+};
+
+/**
+ * Compares two latencies, for sorting them.
+ *
+ * @param left  A pointer to the first latency.
+ * @param right A pointer to the second latency.
+ *
+ * @return Less than, equal to, or greater than 0 as the first latency is less
+ *         than, equal to, or greater than the second.
+ */
+int compareLatencies(const void *left, const void *right) {
+    return (*(const double *) left > *(const double *) right) -
+           (*(const double *) left < *(const double *) right);
+}
+
+/**
+ * Sends every request to a PUNCHCARD in serve mode without waiting for any
+ * answers, then stops sending. Used as the body of the sending thread.
+ *
+ * @param argument A pointer to the struct ServeRequests to send.
+ *
+ * @return thrd_success if everything was sent, thrd_error otherwise.
+ */
+int sendServeRequests(void *argument) {
+    /**
+     * The requests being sent.
+     */
+    struct ServeRequests *requests = argument;
+
+    for (const char *cursor = requests->begin; cursor < requests->end;) {
+        /**
+         * The number of bytes sent.
+         */
+        ssize_t bytesSent = send(requests->socket, cursor,
+                                 (size_t) (requests->end - cursor),
+                                 MSG_NOSIGNAL);
+
+        if (bytesSent == -1) {
+            return thrd_error;
+        }
+        cursor += bytesSent;
+    }
+    shutdown(requests->socket, SHUT_WR);
+    return thrd_success;
+}
+
+/**
+ * Connects to a PUNCHCARD in serve mode.
+ *
+ * @param path The path of the socket it is listening at.
+ *
+ * @return The connected socket, or -1 if it could not connect.
+ */
+int connectServe(const char *path) {
+    /**
+     * The address of the server.
+     */
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+
+    /**
+     * The socket being connected.
+     */
+    int connection;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection != -1 && connect(connection, (struct sockaddr *) &address,
+                                    sizeof(address)) == -1) {
+        close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+/**
+ * Times a PUNCHCARD in serve mode answering the log: first one line at a time,
+ * waiting for each answer before sending the next, for the latency of a single
+ * request, then every line at once over a second connection, for throughput.
+ *
+ * @param settings The settings the log was generated with.
+ * @param path     The path of the socket the server is listening at.
+ * @param begin    The first character of the log.
+ * @param end      One past the last character of the log, just after a
+ *                 newline.
+ */
+void benchmarkServe(const struct BenchSettings *settings, const char *path,
+                    const char *begin, const char *end) {
+    /**
+     * How long each request took to answer, in seconds.
+     */
+    double *latencies = malloc((size_t) settings->lines * sizeof(*latencies));
+
+    /**
+     * The number of requests answered.
+     */
+    long answered = 0;
+
+    /**
+     * Answers read back from the server.
+     */
+    char answers[1 << 16];
+
+    /**
+     * The connection to the server.
+     */
+    int connection = connectServe(path);
+
+    /**
+     * The requests sent all at once, and the thread sending them.
+     */
+    struct ServeRequests requests;
+    thrd_t sender;
+
+    /**
+     * When timing started.
+     */
+    double start;
+
+    if (latencies == NULL || connection == -1) {
+        fprintf(stderr, "[ERROR]\tCOULD NOT CONNECT TO \"%s\".\n", path);
+        free(latencies);
+        return;
+    }
+
+    // Send each line and wait for its answer before sending the next.
+    for (const char *cursor = begin; cursor < end; answered++) {
+        /**
+         * One past the newline ending this line.
+         */
+        const char *lineEnd = (const char *) memchr(cursor, '\n',
+                                                    end - cursor) + 1;
+
+        /**
+         * The number of bytes read back so far.
+         */
+        ssize_t bytesRead = 0;
+
+        start = now();
+        if (send(connection, cursor, (size_t) (lineEnd - cursor),
+                 MSG_NOSIGNAL) == -1) {
+            break;
+        }
+        do {
+            /**
+             * The number of bytes read back this time around.
+             */
+            ssize_t more = recv(connection, answers + bytesRead,
+                                sizeof(answers) - (size_t) bytesRead, 0);
+
+            if (more <= 0) {
+                break;
+            }
+            bytesRead += more;
+        } while (answers[bytesRead - 1] != '\n');
+        latencies[answered] = now() - start;
+        cursor = lineEnd;
+    }
+    close(connection);
+    qsort(latencies, (size_t) answered, sizeof(*latencies), compareLatencies);
+    if (answered > 0) {
+        printf("{\"benchmark\":\"serve.latency\",\"requests\":%ld,"
+               "\"p50_us\":%.2f,\"p99_us\":%.2f,\"p999_us\":%.2f,"
+               "\"max_us\":%.2f}\n", answered,
+               latencies[answered / 2] * 1e6,
+               latencies[answered * 99 / 100] * 1e6,
+               latencies[answered * 999 / 1000] * 1e6,
+               latencies[answered - 1] * 1e6);
+    }
+    free(latencies);
+
+    // Send every line at once from another thread, counting the answers here.
+    requests = (struct ServeRequests) {connectServe(path), begin, end};
+    if (requests.socket == -1) {
+        fprintf(stderr, "[ERROR]\tCOULD NOT CONNECT TO \"%s\".\n", path);
+        return;
+    }
+    answered = 0;
+    start    = now();
+    if (thrd_create(&sender, sendServeRequests, &requests) != thrd_success) {
+        close(requests.socket);
+        return;
+    }
+    while (1) {
+        /**
+         * The number of bytes read back.
+         */
+        ssize_t bytesRead = recv(requests.socket, answers, sizeof(answers), 0);
+
+        if (bytesRead <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < bytesRead; i++) {
+            answered += answers[i] == '\n';
+        }
+    }
+    reportThroughput("serve.pipelined", answered, (size_t) (end - begin),
+                     now() - start);
+    thrd_join(sender, NULL);
+    close(requests.socket);
+}
+#endif
+
+/**
+ * Generates a synthetic punch log and runs every benchmark over it.
+ */
+int main(int argc, char *argv[]) {
+    /**
+     * The settings for this run.
+     */
+    struct BenchSettings settings = {1000000, 3, 0.01, 1, 1};
+
+    /**
+     * Where to write the generated log, if anywhere.
+     */
+    const char *generatePath = NULL;
+
+    /**
+     * The socket of the server to benchmark, if any.
+     */
+    const char *servePath = NULL;
+
+    /**
+     * The generated log.
+     */
+    struct OutputBuffer log;
+
+    // Read the options given.
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            settings.lines = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--intervals") == 0 && i + 1 < argc) {
+            settings.intervals = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--error-rate") == 0 && i + 1 < argc) {
+            settings.errorRate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            settings.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            settings.threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            generatePath = argv[++i];
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            servePath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: punchcard_bench [--lines N] "
+                            "[--intervals N] [--error-rate R] [--seed N] "
+                            "[--threads N] [--generate FILE] "
+                            "[--serve SOCKET]\n");
+            return 1;
+        }
+    }
+    if (settings.lines < 1 || settings.intervals < 1 ||
+        settings.threadCount < 1 ||
+        settings.threadCount > BATCH_MAX_THREADS) {
+        fprintf(stderr, "[ERROR]\tSETTINGS OUT OF RANGE.\n");
+        return 1;
+    }
+
+    // Generate the log, writing it out instead if asked to.
+    if (generatePath != NULL) {
+        /**
+         * The file the log is written to.
+         */
+        struct IoFile *file = ioOpenWrite(generatePath);
+
+        if (file == NULL || outputOpen(&log, file, OUTPUT_BUFFER_SIZE) == -1) {
+            fprintf(stderr, "[ERROR]\tCOULD NOT OPEN \"%s\".\n", generatePath);
+            return 1;
+        }
+        generateLog(&settings, &log);
+        outputClose(&log);
+        return ioClose(file) == -1 ? 1 : 0;
+    }
+    if (outputOpen(&log, NULL, OUTPUT_BUFFER_SIZE) == -1) {
+        fprintf(stderr, "[ERROR]\tOUT OF MEMORY.\n");
+        return 1;
+    }
+    generateLog(&settings, &log);
+
+    // Run every benchmark, or just the server's if asked to.
+    printf("{\"settings\":{\"lines\":%ld,\"intervals\":%d,\"error_rate\":%g,"
+           "\"seed\":%llu,\"threads\":%d,\"bytes\":%zu}}\n", settings.lines,
+           settings.intervals, settings.errorRate,
+           (unsigned long long) settings.seed, settings.threadCount,
+           log.length);
+    if (servePath != NULL) {
+#if defined(PUNCHCARD_SERVE)
+        benchmarkServe(&settings, servePath, log.data, log.data + log.length);
+#else
+        fprintf(stderr, "[ERROR]\tSERVE MODE IS ONLY AVAILABLE ON LINUX.\n");
+#endif
+        free(log.data);
+        return 0;
+    }
+    benchmarkReadTime(log.data, log.data + log.length);
+    benchmarkClearBufferJunk(log.data, log.data + log.length);
+    benchmarkTimeMath(2000);
+    benchmarkLibrary(&settings, log.data, log.data + log.length);
+    benchmarkOutput(&settings, log.data, log.data + log.length);
+    benchmarkBatch(&settings, log.data, log.data + log.length);
+
+    free(log.data);
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details The files PUNCHCARD reads and writes, behind an interface small
+ * enough to sit directly on the operating system. Two backends implement it:
+ * io_posix.c, which calls read(2) and write(2) directly, and io_stdio.c, which
+ * uses standard C streams on platforms without them. CMakeLists.txt picks one.
+ * Neither buffers anything; callers collect data into large pieces themselves.
+ */
+
+#ifndef PUNCHCARD_IO_H
+#define PUNCHCARD_IO_H
+
+// Libraries in use:
+#include <stddef.h>
+
+// Types
+/**
+ * A file opened through the I/O backend.
+ */
+struct IoFile;
+
+// Functions
+/**
+ * Opens a file for reading, in binary.
+ *
+ * @param path The path of the file to open.
+ *
+ * @return The opened file, or NULL if it could not be opened.
+ */
+struct IoFile *ioOpenRead(const char *path);
+
+/**
+ * Opens a file for writing, in binary, creating it or emptying it first.
+ *
+ * @param path The path of the file to open.
+ *
+ * @return The opened file, or NULL if it could not be opened.
+ */
+struct IoFile *ioOpenWrite(const char *path);
+
+/**
+ * Gets the standard input of the program.
+ *
+ * @return The standard input.
+ */
+struct IoFile *ioStandardInput(void);
+
+/**
+ * Gets the standard output of the program.
+ *
+ * @return The standard output.
+ */
+struct IoFile *ioStandardOutput(void);
+
+/**
+ * Gets the standard error of the program.
+ *
+ * @return The standard error.
+ */
+struct IoFile *ioStandardError(void);
+
+/**
+ * Reads up to the given number of bytes from a file, returning as soon as any
+ * are available, so a prompt gets each line as it is typed.
+ *
+ * @param file   The file to read from.
+ * @param buffer The buffer to read into.
+ * @param size   The most bytes to read.
+ *
+ * @return The number of bytes read, or 0 at the end of the file or on an error.
+ */
+size_t ioRead(struct IoFile *file, void *buffer, size_t size);
+
+/**
+ * Writes every one of the given bytes to a file.
+ *
+ * @param file The file to write to.
+ * @param data The bytes to write.
+ * @param size The number of bytes to write.
+ *
+ * @return 0 if everything was written, -1 if there was an error.
+ */
+int ioWrite(struct IoFile *file, const void *data, size_t size);
+
+/**
+ * Makes sure everything written to a file has reached the disk, so it survives
+ * a crash of the whole machine.
+ *
+ * @param file The file to sync.
+ *
+ * @return 0 if the file was synced, -1 if it could not be.
+ */
+int ioSync(struct IoFile *file);
+
+/**
+ * Checks whether any read from or write to a file has failed.
+ *
+ * @param file The file to check.
+ *
+ * @return 1 if anything has failed, 0 otherwise.
+ */
+int ioError(const struct IoFile *file);
+
+/**
+ * Closes a file opened by ioOpenRead() or ioOpenWrite().
+ *
+ * @param file The file to close.
+ *
+ * @return 0 if the file was closed, -1 if there was an error doing so, such as
+ *         data that could not be written.
+ */
+int ioClose(struct IoFile *file);
+
+/**
+ * Renames a file, replacing any file already at the new path in a single step,
+ * so anything reading the new path sees either the old file or the new one and
+ * never a mix of the two.
+ *
+ * @param from The path of the file to rename.
+ * @param to   The path to rename it to.
+ *
+ * @return 0 if the file was renamed, -1 if it could not be.
+ */
+int ioReplace(const char *from, const char *to);
+
+/**
+ * Deletes a file.
+ *
+ * @param path The path of the file to delete.
+ *
+ * @return 0 if the file was deleted, -1 if it could not be.
+ */
+int ioRemove(const char *path);
+
+#endif
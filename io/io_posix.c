@@ -0,0 +1,208 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details The I/O backend for POSIX systems, calling read(2) and write(2) on
+ * file descriptors directly, with no stdio buffering or formatting in between.
+ */
+
+// Libraries in use:
+#include "io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Types
+/**
+ * A file opened through the I/O backend.
+ */
+struct IoFile {
+    /**
+     * The file descriptor of the file.
+     */
+    int descriptor;
+
+    /**
+     * Whether any read or write has failed.
+     */
+    int failed;
+};
+
+// Standard streams
+/**
+ * The standard input, output, and error of the program.
+ */
+static struct IoFile standardInput  = {STDIN_FILENO, 0};
+static struct IoFile standardOutput = {STDOUT_FILENO, 0};
+static struct IoFile standardError  = {STDERR_FILENO, 0};
+
+// Functions
+/**
+ * Opens a file with the given flags.
+ *
+ * @param path  The path of the file to open.
+ * @param flags The flags to pass to open(2).
+ *
+ * @return The opened file, or NULL if it could not be opened.
+ */
+static struct IoFile *openFile(const char *path, int flags) {
+    /**
+     * The file being opened.
+     */
+    struct IoFile *file = malloc(sizeof(*file));
+
+    if (file == NULL) {
+        return NULL;
+    }
+    file->descriptor = open(path, flags, 0666);
+    file->failed     = 0;
+    if (file->descriptor == -1) {
+        free(file);
+        return NULL;
+    }
+    return file;
+}
+
+/**
+ * Opens a file for reading with open(2).
+ */
+struct IoFile *ioOpenRead(const char *path) {
+    return openFile(path, O_RDONLY);
+}
+
+/**
+ * Opens a file for writing with open(2).
+ */
+struct IoFile *ioOpenWrite(const char *path) {
+    return openFile(path, O_WRONLY | O_CREAT | O_TRUNC);
+}
+
+/**
+ * Gets file descriptor 0.
+ */
+struct IoFile *ioStandardInput(void) {
+    return &standardInput;
+}
+
+/**
+ * Gets file descriptor 1.
+ */
+struct IoFile *ioStandardOutput(void) {
+    return &standardOutput;
+}
+
+/**
+ * Gets file descriptor 2.
+ */
+struct IoFile *ioStandardError(void) {
+    return &standardError;
+}
+
+/**
+ * Reads with a single read(2), which returns as soon as anything is available.
+ */
+size_t ioRead(struct IoFile *file, void *buffer, size_t size) {
+    /**
+     * The number of bytes read, or -1 on an error.
+     */
+    ssize_t bytesRead;
+
+    // Try again if interrupted before anything was read.
+    do {
+        bytesRead = read(file->descriptor, buffer, size);
+    } while (bytesRead == -1 && errno == EINTR);
+
+    if (bytesRead == -1) {
+        file->failed = 1;
+        return 0;
+    }
+    return (size_t) bytesRead;
+}
+
+/**
+ * Writes with write(2), as many times as it takes.
+ */
+int ioWrite(struct IoFile *file, const void *data, size_t size) {
+    /**
+     * The next byte to write.
+     */
+    const char *cursor = data;
+
+    // A single write(2) can take less than everything, so keep going.
+    while (size > 0) {
+        /**
+         * The number of bytes written, or -1 on an error.
+         */
+        ssize_t bytesWritten = write(file->descriptor, cursor, size);
+
+        if (bytesWritten == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            file->failed = 1;
+            return -1;
+        }
+        cursor += bytesWritten;
+        size -= (size_t) bytesWritten;
+    }
+    return 0;
+}
+
+/**
+ * Syncs with fsync(2).
+ */
+int ioSync(struct IoFile *file) {
+    return fsync(file->descriptor) == -1 ? -1 : 0;
+}
+
+/**
+ * Checks whether anything has failed.
+ */
+int ioError(const struct IoFile *file) {
+    return file->failed;
+}
+
+/**
+ * Closes with close(2).
+ */
+int ioClose(struct IoFile *file) {
+    /**
+     * Whether the file was closed cleanly.
+     */
+    int status = close(file->descriptor) == -1 || file->failed ? -1 : 0;
+
+    free(file);
+    return status;
+}
+
+/**
+ * Renames with rename(2), which replaces the new path in a single step.
+ */
+int ioReplace(const char *from, const char *to) {
+    return rename(from, to) == -1 ? -1 : 0;
+}
+
+/**
+ * Deletes with unlink(2).
+ */
+int ioRemove(const char *path) {
+    return unlink(path) == -1 ? -1 : 0;
+}
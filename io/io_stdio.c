@@ -0,0 +1,231 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details The I/O backend for platforms without POSIX file descriptors, built
+ * on standard C streams. Only unformatted reads and writes are used, so nothing
+ * beyond the C standard library is needed.
+ */
+
+// Libraries in use:
+#include "io.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Replacing files in a single step, which rename() doesn't do on Windows.
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// Types
+/**
+ * A file opened through the I/O backend.
+ */
+struct IoFile {
+    /**
+     * The stream of the file, or NULL for a standard stream not looked up yet.
+     */
+    FILE *stream;
+
+    /**
+     * Whether any read or write has failed.
+     */
+    int failed;
+};
+
+// Standard streams
+/**
+ * The standard input, output, and error of the program. Their streams aren't
+ * constant expressions, so they are filled in when first asked for.
+ */
+static struct IoFile standardInput  = {NULL, 0};
+static struct IoFile standardOutput = {NULL, 0};
+static struct IoFile standardError  = {NULL, 0};
+
+// Functions
+/**
+ * Opens a file with the given mode.
+ *
+ * @param path The path of the file to open.
+ * @param mode The mode to pass to fopen().
+ *
+ * @return The opened file, or NULL if it could not be opened.
+ */
+static struct IoFile *openFile(const char *path, const char *mode) {
+    /**
+     * The file being opened.
+     */
+    struct IoFile *file = malloc(sizeof(*file));
+
+    if (file == NULL) {
+        return NULL;
+    }
+#if defined(_MSC_VER)
+    if (fopen_s(&file->stream, path, mode) != 0) {
+        file->stream = NULL;
+    }
+#else
+    file->stream = fopen(path, mode);
+#endif
+    file->failed = 0;
+    if (file->stream == NULL) {
+        free(file);
+        return NULL;
+    }
+    return file;
+}
+
+/**
+ * Opens a file for reading with fopen().
+ */
+struct IoFile *ioOpenRead(const char *path) {
+    return openFile(path, "rb");
+}
+
+/**
+ * Opens a file for writing with fopen().
+ */
+struct IoFile *ioOpenWrite(const char *path) {
+    return openFile(path, "wb");
+}
+
+/**
+ * Gets stdin.
+ */
+struct IoFile *ioStandardInput(void) {
+    standardInput.stream = stdin;
+    return &standardInput;
+}
+
+/**
+ * Gets stdout.
+ */
+struct IoFile *ioStandardOutput(void) {
+    standardOutput.stream = stdout;
+    return &standardOutput;
+}
+
+/**
+ * Gets stderr.
+ */
+struct IoFile *ioStandardError(void) {
+    standardError.stream = stderr;
+    return &standardError;
+}
+
+/**
+ * Reads with fread(). Reading stops early at the end of a line typed into a
+ * terminal, since fread() only returns once it has everything asked for. The
+ * end-of-file indicator is cleared first, so a file still being written to can
+ * be read again once more has been added.
+ */
+size_t ioRead(struct IoFile *file, void *buffer, size_t size) {
+    /**
+     * The bytes read so far.
+     */
+    char *cursor = buffer;
+
+    if (feof(file->stream)) {
+        clearerr(file->stream);
+    }
+
+    // Read a character at a time from the terminal, and all at once otherwise.
+    if (file->stream == stdin) {
+        while (size > 0) {
+            /**
+             * The character read.
+             */
+            int character = getc(file->stream);
+
+            if (character == EOF) {
+                break;
+            }
+            *cursor++ = (char) character;
+            size--;
+            if (character == '\n') {
+                break;
+            }
+        }
+    } else {
+        cursor += fread(buffer, 1, size, file->stream);
+    }
+    if (ferror(file->stream)) {
+        file->failed = 1;
+    }
+    return (size_t) (cursor - (char *) buffer);
+}
+
+/**
+ * Writes with fwrite(), then flushes so a prompt shows straight away.
+ */
+int ioWrite(struct IoFile *file, const void *data, size_t size) {
+    if (fwrite(data, 1, size, file->stream) != size ||
+        fflush(file->stream) != 0) {
+        file->failed = 1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Syncs with fflush(), which is as far as standard C can push the data.
+ */
+int ioSync(struct IoFile *file) {
+    return fflush(file->stream) == 0 ? 0 : -1;
+}
+
+/**
+ * Checks whether anything has failed.
+ */
+int ioError(const struct IoFile *file) {
+    return file->failed;
+}
+
+/**
+ * Closes with fclose().
+ */
+int ioClose(struct IoFile *file) {
+    /**
+     * Whether the file was closed cleanly.
+     */
+    int status = fclose(file->stream) != 0 || file->failed ? -1 : 0;
+
+    free(file);
+    return status;
+}
+
+/**
+ * Renames with MoveFileEx() on Windows, and with rename() everywhere else.
+ */
+int ioReplace(const char *from, const char *to) {
+#if defined(_WIN32)
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING |
+                                 MOVEFILE_WRITE_THROUGH) ? 0 : -1;
+#else
+    return rename(from, to) == 0 ? 0 : -1;
+#endif
+}
+
+/**
+ * Deletes with remove().
+ */
+int ioRemove(const char *path) {
+    return remove(path) == 0 ? 0 : -1;
+}
@@ -0,0 +1,1643 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details The core of PUNCHCARD: reading times out of a buffer, summing the
+ * time worked between them, and rounding the totals. Everything here works on
+ * memory the caller owns, with no I/O, no state kept between calls, and no
+ * allocation, so the front end and any other program can share it. The only
+ * data of its own is a pair of read-only tables built at compile time.
+ */
+
+// Libraries in use:
+#include "punchcard.h"
+
+#include <string.h>
+
+// Vector instructions, where the compiler has them available.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PUNCHCARD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PUNCHCARD_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Constants
+/**
+ * The number of daily totals, in minutes, covered by the rounding and hour
+ * string tables. Totals this large or larger are handled arithmetically.
+ */
+#define ROUND_TABLE_MINUTES (48 * 60)
+
+/**
+ * The number of quarter-hours covered by the hour string table, from 0.00 up to
+ * and including 48.00.
+ */
+#define QUARTER_STRING_COUNT (48 * 4 + 1)
+
+/**
+ * The longest line, in bytes, the vectorized fast path will parse. Longer lines
+ * are left to the scalar scanner.
+ */
+#define FAST_LINE_SIZE 256
+
+/**
+ * The number of 64-bit words needed to hold one bit per byte of a line the
+ * fast path will parse.
+ */
+#define FAST_LINE_WORDS (FAST_LINE_SIZE / 64)
+
+/**
+ * The number of bytes classified at once when finding delimiters.
+ */
+#define FAST_WINDOW_SIZE 32
+
+/**
+ * The most intervals sorted by the sorting network. More are sorted by
+ * insertion instead.
+ */
+#define NETWORK_SIZE 8
+
+/**
+ * The number of compare-exchanges in the sorting network.
+ */
+#define NETWORK_COMPARATORS 19
+
+// Types
+/**
+ * Bitmasks marking where each kind of delimiter appears in a line, one bit per
+ * byte, with bit i of word i / 64 standing for byte i.
+ */
+struct DelimiterMasks {
+    /**
+     * Where the ':' between each hour and minute appear.
+     */
+    uint64_t colons[FAST_LINE_WORDS];
+
+    /**
+     * Where the '-' between each start and end time appear.
+     */
+    uint64_t hyphens[FAST_LINE_WORDS];
+
+    /**
+     * Where the ',' between each interval appear.
+     */
+    uint64_t commas[FAST_LINE_WORDS];
+
+    /**
+     * Where the 'm' or 'M' ending each meridiem indicator appear.
+     */
+    uint64_t ms[FAST_LINE_WORDS];
+
+    /**
+     * Where whitespace appears.
+     */
+    uint64_t spaces[FAST_LINE_WORDS];
+};
+
+// Tables
+/**
+ * Repeats a value 7, 8, or 15 times, for building the rounding table.
+ */
+#define REPEAT_7(x) x, x, x, x, x, x, x
+#define REPEAT_8(x) REPEAT_7(x), x
+#define REPEAT_15(x) REPEAT_8(x), REPEAT_7(x)
+
+/**
+ * The nearest quarter-hour for each of the 60 minutes starting at an hour:
+ * minutes 0-7 round down to the hour, 8-22 to a quarter past, 23-37 to half
+ * past, 38-52 to a quarter to, and 53-59 up to the next hour.
+ */
+#define ROUND_HOUR(h) \
+    REPEAT_8(4 * (h)), REPEAT_15(4 * (h) + 1), REPEAT_15(4 * (h) + 2), \
+    REPEAT_15(4 * (h) + 3), REPEAT_7(4 * (h) + 4)
+#define ROUND_8_HOURS(h) \
+    ROUND_HOUR(h), ROUND_HOUR((h) + 1), ROUND_HOUR((h) + 2), \
+    ROUND_HOUR((h) + 3), ROUND_HOUR((h) + 4), ROUND_HOUR((h) + 5), \
+    ROUND_HOUR((h) + 6), ROUND_HOUR((h) + 7)
+
+/**
+ * The number of quarter-hours each daily total of minutes rounds to, the same
+ * as (minutes + 7) / 15. Built entirely at compile time.
+ */
+static const uint8_t roundedQuarters[ROUND_TABLE_MINUTES] = {
+        ROUND_8_HOURS(0), ROUND_8_HOURS(8), ROUND_8_HOURS(16),
+        ROUND_8_HOURS(24), ROUND_8_HOURS(32), ROUND_8_HOURS(40)};
+
+/**
+ * The four quarter-hours of an hour, written out as decimal hours.
+ */
+#define QUARTER_STRINGS(h) #h ".00", #h ".25", #h ".50", #h ".75"
+
+/**
+ * Each number of quarter-hours written out as decimal hours with two places,
+ * the same as "%0.2f" would write them, so rounded totals can be printed
+ * without any formatting.
+ */
+static const char quarterStrings[QUARTER_STRING_COUNT][6] = {
+        QUARTER_STRINGS(0), QUARTER_STRINGS(1), QUARTER_STRINGS(2),
+        QUARTER_STRINGS(3), QUARTER_STRINGS(4), QUARTER_STRINGS(5),
+        QUARTER_STRINGS(6), QUARTER_STRINGS(7), QUARTER_STRINGS(8),
+        QUARTER_STRINGS(9), QUARTER_STRINGS(10), QUARTER_STRINGS(11),
+        QUARTER_STRINGS(12), QUARTER_STRINGS(13), QUARTER_STRINGS(14),
+        QUARTER_STRINGS(15), QUARTER_STRINGS(16), QUARTER_STRINGS(17),
+        QUARTER_STRINGS(18), QUARTER_STRINGS(19), QUARTER_STRINGS(20),
+        QUARTER_STRINGS(21), QUARTER_STRINGS(22), QUARTER_STRINGS(23),
+        QUARTER_STRINGS(24), QUARTER_STRINGS(25), QUARTER_STRINGS(26),
+        QUARTER_STRINGS(27), QUARTER_STRINGS(28), QUARTER_STRINGS(29),
+        QUARTER_STRINGS(30), QUARTER_STRINGS(31), QUARTER_STRINGS(32),
+        QUARTER_STRINGS(33), QUARTER_STRINGS(34), QUARTER_STRINGS(35),
+        QUARTER_STRINGS(36), QUARTER_STRINGS(37), QUARTER_STRINGS(38),
+        QUARTER_STRINGS(39), QUARTER_STRINGS(40), QUARTER_STRINGS(41),
+        QUARTER_STRINGS(42), QUARTER_STRINGS(43), QUARTER_STRINGS(44),
+        QUARTER_STRINGS(45), QUARTER_STRINGS(46), QUARTER_STRINGS(47),
+        "48.00"};
+
+/**
+ * A sorting network for NETWORK_SIZE elements, as the pairs of positions to
+ * compare and exchange in order. 19 is the fewest comparisons that can sort
+ * eight elements, and with no branches to mispredict, this beats insertion
+ * sort on the handful of intervals a day usually has.
+ */
+static const uint8_t sortingNetwork[NETWORK_COMPARATORS][2] = {
+        {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
+        {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6},
+        {1, 2}, {3, 4}, {5, 6}};
+
+// Functions
+/**
+ * Consumes characters from an in-memory buffer until finding the end of the
+ * buffer, a newline, or the target character. This is the buffer equivalent of
+ * clearBufferJunk().
+ *
+ * @param cursor A pointer to the pointer walking the buffer. On return, it
+ *               points just past the character that stopped the scan.
+ * @param end    A pointer one past the last character of the buffer.
+ * @param target The target char to stop consuming characters after
+ *               encountering.
+ *
+ * @return -1 if stopped by the end of the buffer, 1 if stopped by a newline, 0
+ *         if stopped by the target character, and 2 otherwise.
+ */
+int skipBufferJunk(const char **cursor, const char *end, char target) {
+    // Consume characters until we encounter a stop condition.
+    while (*cursor < end) {
+        /**
+         * The character currently being consumed.
+         */
+        char current = *(*cursor)++;
+
+        // Return an int signifying the reason for stopping.
+        if (current == target && target != '\n') {
+            return 0;
+        } else if (current == '\n') {
+            return 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Skips any whitespace at the cursor, the same way a space in a scanf_s()
+ * format string would.
+ *
+ * @param cursor A pointer to the pointer walking the buffer.
+ * @param end    A pointer one past the last character of the buffer.
+ */
+void skipBufferSpace(const char **cursor, const char *end) {
+    while (*cursor < end && (**cursor == ' ' || **cursor == '\t' ||
+                             **cursor == '\r' || **cursor == '\n' ||
+                             **cursor == '\v' || **cursor == '\f')) {
+        (*cursor)++;
+    }
+}
+
+/**
+ * Reads a possibly signed decimal number at the cursor, the same way "%d" in a
+ * scanf_s() format string would. Numbers too long to be a valid hour or minute
+ * are clamped rather than allowed to overflow.
+ *
+ * @param cursor A pointer to the pointer walking the buffer.
+ * @param end    A pointer one past the last character of the buffer.
+ * @param value  A pointer to the int to store the number read in.
+ *
+ * @return 0 if a number was read, -1 if there were no digits at the cursor.
+ */
+static int scanBufferNumber(const char **cursor, const char *end,
+                            int *value) {
+    /**
+     * Whether the number read is negative.
+     */
+    int negative = 0;
+
+    /**
+     * The number of digits read.
+     */
+    int digits = 0;
+
+    // Read the sign, if there is one.
+    if (*cursor < end && (**cursor == '-' || **cursor == '+')) {
+        negative = **cursor == '-';
+        (*cursor)++;
+    }
+
+    // Accumulate the digits.
+    *value = 0;
+    while (*cursor < end && **cursor >= '0' && **cursor <= '9') {
+        if (*value < 100000) {
+            *value = *value * 10 + (**cursor - '0');
+        }
+        (*cursor)++;
+        digits++;
+    }
+
+    if (negative) {
+        *value = -*value;
+    }
+    return digits > 0 ? 0 : -1;
+}
+
+/**
+ * Attempts to parse the next time in an in-memory buffer, in the format
+ * HH:MMcc, where HH is the hour, MM is the minute, and cc is the meridiem
+ * indicator ("am" or "pm"). Whitespace is allowed around each part, the same
+ * as the " %d : %d %c" scanf_s() format this replaces, but the common compact
+ * forms "H:MMc" and "HH:MMc", with a letter straight after the minutes, are
+ * decoded directly without scanning piecewise. Only the first character of the
+ * meridiem indicator is consumed.
+ *
+ * @param cursor   A pointer to the pointer walking the buffer. On return, it
+ *                 points just past the last character of the time.
+ * @param end      A pointer one past the last character of the buffer.
+ * @param hour     A pointer to the int storing the hour for this time.
+ * @param minute   A pointer to the int storing the minute for this time.
+ * @param meridiem A pointer to the char storing the meridiem indicator for this
+ *                 time, converted to lowercase.
+ *
+ * @return TIME_OK if a valid time was read, otherwise every TimeError flag
+ *         describing what was wrong with the read time.
+ */
+int parseTime(const char **cursor, const char *end, int *hour, int *minute,
+              char *meridiem) {
+    /**
+     * The position in the buffer being read.
+     */
+    const char *position;
+
+    /**
+     * The number of characters left in the buffer.
+     */
+    ptrdiff_t remaining;
+
+    skipBufferSpace(cursor, end);
+    position  = *cursor;
+    remaining = end - position;
+
+    // Decode the compact forms in one go if that's what we're looking at. The
+    // meridiem has to follow the minutes directly, so spaced meridiems and
+    // longer minutes are left to the piecewise scan.
+    if (remaining >= 5 && (unsigned) (position[0] - '0') < 10 &&
+        position[1] == ':' && (unsigned) (position[2] - '0') < 10 &&
+        (unsigned) (position[3] - '0') < 10 &&
+        (unsigned) ((position[4] | 0x20) - 'a') < 26) {
+        *hour     = position[0] - '0';
+        *minute   = (position[2] - '0') * 10 + (position[3] - '0');
+        *meridiem = position[4];
+        *cursor   = position + 5;
+    } else if (remaining >= 6 && (unsigned) (position[0] - '0') < 10 &&
+               (unsigned) (position[1] - '0') < 10 && position[2] == ':' &&
+               (unsigned) (position[3] - '0') < 10 &&
+               (unsigned) (position[4] - '0') < 10 &&
+               (unsigned) ((position[5] | 0x20) - 'a') < 26) {
+        *hour     = (position[0] - '0') * 10 + (position[1] - '0');
+        *minute   = (position[3] - '0') * 10 + (position[4] - '0');
+        *meridiem = position[5];
+        *cursor   = position + 6;
+    } else {
+        // Otherwise, scan the time in piece by piece, as " %d : %d %c" would.
+        if (scanBufferNumber(cursor, end, hour) == -1) {
+            return TIME_MALFORMED;
+        }
+        skipBufferSpace(cursor, end);
+        if (*cursor >= end || **cursor != ':') {
+            return TIME_MALFORMED;
+        }
+        (*cursor)++;
+        skipBufferSpace(cursor, end);
+        if (scanBufferNumber(cursor, end, minute) == -1) {
+            return TIME_MALFORMED;
+        }
+        skipBufferSpace(cursor, end);
+        if (*cursor >= end) {
+            return TIME_MALFORMED;
+        }
+        *meridiem = *(*cursor)++;
+    }
+
+    // It's a lot easier if we just convert uppercase to lowercase.
+    if (*meridiem == 'A' || *meridiem == 'P') {
+        *meridiem = (char) (*meridiem + ('a' - 'A'));
+    }
+
+    // Collect everything wrong with the time without branching on each check.
+    return (*hour <= 0) * TIME_HOUR_TOO_SMALL |
+           (*hour >= 13) * TIME_HOUR_TOO_BIG |
+           (*minute <= -1) * TIME_MINUTE_TOO_SMALL |
+           (*minute >= 60) * TIME_MINUTE_TOO_BIG |
+           (*meridiem != 'a' && *meridiem != 'p') * TIME_BAD_MERIDIEM;
+}
+
+/**
+ * Converts a 12-hour time to the number of minutes since midnight, because it
+ * is easier to do math with. 12am is midnight and 12pm is noon.
+ *
+ * @param hour     The hour of the time to convert (12-hour time).
+ * @param minute   The minute of the time to convert.
+ * @param meridiem The first character of the meridiem indicator for the time
+ *                 to convert ('a' or 'p').
+ *
+ * @return The number of minutes since midnight, from 0 to 1439.
+ */
+uint16_t toMinutes(int hour, int minute, char meridiem) {
+    return (uint16_t) ((hour % 12 + (meridiem == 'p') * 12) * 60 + minute);
+}
+
+/**
+ * Calculates the time worked between a start time and an end time. An end time
+ * earlier than the start time is taken to be on the following day.
+ *
+ * @param start The time work was started at, in minutes since midnight.
+ * @param end   The time work ended at, in minutes since midnight.
+ *
+ * @return The number of minutes worked, from 0 to 1439.
+ */
+int difference(uint16_t start, uint16_t end) {
+    return (end - start + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+}
+
+/**
+ * Rounds the total time worked to the nearest quarter-hour.
+ *
+ * @param totalMinutes A pointer to the int storing the total minutes worked.
+ */
+void roundTime(int *totalMinutes) {
+    *totalMinutes = roundQuarterHour(*totalMinutes);
+}
+
+/**
+ * Rounds minutes worked to the nearest quarter-hour, looking the total up if it
+ * is small enough.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundQuarterHour(int minutes) {
+    if (minutes >= 0 && minutes < ROUND_TABLE_MINUTES) {
+        return roundedQuarters[minutes] * 15;
+    }
+    return roundToStep(minutes, 15, 8);
+}
+
+/**
+ * Rounds minutes worked down to the last whole quarter-hour.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundQuarterHourDown(int minutes) {
+    return roundToStep(minutes, 15, 15);
+}
+
+/**
+ * Rounds minutes worked to the nearest tenth of an hour, so 3 minutes past a
+ * tenth rounds up and 2 rounds down.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundTenthHour(int minutes) {
+    return roundToStep(minutes, 6, 3);
+}
+
+/**
+ * Rounds minutes worked down to the last whole tenth of an hour.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundTenthHourDown(int minutes) {
+    return roundToStep(minutes, 6, 6);
+}
+
+/**
+ * Finds the function for a rounding policy, so it can be looked up once and
+ * called directly for every total after.
+ *
+ * @param policy The rounding policy.
+ *
+ * @return The function rounding minutes by the policy, or NULL if there is no
+ *         such policy.
+ */
+RoundingFunction findRoundingFunction(enum RoundingPolicy policy) {
+    switch (policy) {
+        case ROUND_QUARTER_HOUR:
+            return roundQuarterHour;
+        case ROUND_QUARTER_HOUR_DOWN:
+            return roundQuarterHourDown;
+        case ROUND_TENTH_HOUR:
+            return roundTenthHour;
+        case ROUND_TENTH_HOUR_DOWN:
+            return roundTenthHourDown;
+    }
+    return NULL;
+}
+
+/**
+ * Counts the bits set in a word.
+ *
+ * @param word The word to count the bits of.
+ *
+ * @return The number of bits set.
+ */
+static inline int countBits(uint64_t word) {
+#if defined(_MSC_VER)
+    return (int) __popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+/**
+ * Finds the lowest bit set in a word.
+ *
+ * @param word The word to search, which must not be 0.
+ *
+ * @return The index of the lowest bit set.
+ */
+static inline int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int) index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+/**
+ * Counts the bits set in a mask between two byte positions.
+ *
+ * @param mask The mask to count within.
+ * @param from The first byte position to count.
+ * @param to   One past the last byte position to count.
+ *
+ * @return The number of bits set in [from, to).
+ */
+static int countMaskRange(const uint64_t *mask, size_t from, size_t to) {
+    /**
+     * The number of bits found so far.
+     */
+    int count = 0;
+
+    // Count a word at a time, trimming the bits outside the range.
+    while (from < to) {
+        /**
+         * The word holding the current position.
+         */
+        size_t word = from / 64;
+
+        /**
+         * One past the last position to count within this word.
+         */
+        size_t stop = to < (word + 1) * 64 ? to : (word + 1) * 64;
+
+        /**
+         * The bits of this word that fall inside the range.
+         */
+        uint64_t bits = mask[word] >> (from % 64);
+
+        if (stop - from < 64) {
+            bits &= ((uint64_t) 1 << (stop - from)) - 1;
+        }
+        count += countBits(bits);
+        from = stop;
+    }
+    return count;
+}
+
+/**
+ * Marks where every delimiter appears in a window of bytes. Uses AVX2 or SSE2
+ * where available to classify many bytes with each instruction, and falls back
+ * to checking one byte at a time otherwise.
+ *
+ * @param window The bytes to classify. FAST_WINDOW_SIZE of them are read.
+ * @param bit    The position of the first byte of the window within the line.
+ * @param masks  The masks to mark the delimiters in.
+ */
+static void classifyWindow(const char *window, size_t bit,
+                           struct DelimiterMasks *masks) {
+#if defined(PUNCHCARD_AVX2)
+    /**
+     * The bytes being classified.
+     */
+    __m256i bytes = _mm256_loadu_si256((const __m256i *) window);
+
+    /**
+     * The bytes being classified, with letters forced to lowercase.
+     */
+    __m256i lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+
+    /**
+     * Where the tab, newline, vertical tab, form feed, and carriage return
+     * characters appear, which happen to be consecutive.
+     */
+    __m256i controls = _mm256_cmpeq_epi8(
+            _mm256_min_epu8(_mm256_sub_epi8(bytes, _mm256_set1_epi8('\t')),
+                            _mm256_set1_epi8('\r' - '\t')),
+            _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t')));
+    uint64_t colons  = (uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')));
+    uint64_t hyphens = (uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('-')));
+    uint64_t commas  = (uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(',')));
+    uint64_t ms      = (uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('m')));
+    uint64_t spaces  = (uint32_t) _mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), controls));
+#elif defined(PUNCHCARD_SSE2)
+    uint64_t colons  = 0;
+    uint64_t hyphens = 0;
+    uint64_t commas  = 0;
+    uint64_t ms      = 0;
+    uint64_t spaces  = 0;
+
+    // Classify the window in two halves.
+    for (int half = 0; half < FAST_WINDOW_SIZE; half += 16) {
+        /**
+         * The bytes being classified.
+         */
+        __m128i bytes = _mm_loadu_si128((const __m128i *) (window + half));
+
+        /**
+         * The bytes being classified, with letters forced to lowercase.
+         */
+        __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+
+        /**
+         * Where the tab, newline, vertical tab, form feed, and carriage return
+         * characters appear, which happen to be consecutive.
+         */
+        __m128i controls = _mm_cmpeq_epi8(
+                _mm_min_epu8(_mm_sub_epi8(bytes, _mm_set1_epi8('\t')),
+                             _mm_set1_epi8('\r' - '\t')),
+                _mm_sub_epi8(bytes, _mm_set1_epi8('\t')));
+
+        colons |= (uint64_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8(':'))) << half;
+        hyphens |= (uint64_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-'))) << half;
+        commas |= (uint64_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8(','))) << half;
+        ms |= (uint64_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(lower, _mm_set1_epi8('m'))) << half;
+        spaces |= (uint64_t) _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), controls)) << half;
+    }
+#else
+    uint64_t colons  = 0;
+    uint64_t hyphens = 0;
+    uint64_t commas  = 0;
+    uint64_t ms      = 0;
+    uint64_t spaces  = 0;
+
+    // Classify the window one byte at a time.
+    for (int i = 0; i < FAST_WINDOW_SIZE; i++) {
+        colons |= (uint64_t) (window[i] == ':') << i;
+        hyphens |= (uint64_t) (window[i] == '-') << i;
+        commas |= (uint64_t) (window[i] == ',') << i;
+        ms |= (uint64_t) ((window[i] | 0x20) == 'm') << i;
+        spaces |= (uint64_t) (window[i] == ' ' ||
+                              (window[i] >= '\t' && window[i] <= '\r')) << i;
+    }
+#endif
+
+    // Store the window's bits in its place within the line.
+    masks->colons[bit / 64] |= colons << (bit % 64);
+    masks->hyphens[bit / 64] |= hyphens << (bit % 64);
+    masks->commas[bit / 64] |= commas << (bit % 64);
+    masks->ms[bit / 64] |= ms << (bit % 64);
+    masks->spaces[bit / 64] |= spaces << (bit % 64);
+}
+
+/**
+ * Marks where every delimiter appears in a line, a window at a time.
+ *
+ * @param line   A pointer to the first character of the line.
+ * @param length The length of the line, at most FAST_LINE_SIZE.
+ * @param masks  The masks to mark the delimiters in.
+ */
+static void findDelimiters(const char *line, size_t length,
+                           struct DelimiterMasks *masks) {
+    /**
+     * The position within the line of the window being classified.
+     */
+    size_t position = 0;
+
+    memset(masks, 0, sizeof(*masks));
+
+    // Classify every whole window straight out of the line.
+    for (; position + FAST_WINDOW_SIZE <= length;
+           position += FAST_WINDOW_SIZE) {
+        classifyWindow(line + position, position, masks);
+    }
+
+    // Copy out the partial window at the end, so we don't read past the line.
+    if (position < length) {
+        /**
+         * The rest of the line, padded with characters that aren't delimiters.
+         */
+        char tail[FAST_WINDOW_SIZE] = {0};
+
+        memcpy(tail, line + position, length - position);
+        classifyWindow(tail, position, masks);
+    }
+}
+
+/**
+ * Attempts to sum the times on a line using the delimiter masks rather than
+ * scanning each character. Only handles lines made up entirely of compact
+ * "H:MMcm" or "HH:MMcm" times separated by hyphens and commas with optional
+ * whitespace, where every time is valid, which is what nearly all batch input
+ * looks like. Anything else is left to sumTimesInLine() to parse and report.
+ *
+ * @param line           A pointer to the first character of the line.
+ * @param end            A pointer one past the last character of the line.
+ * @param roundInterval  The function to round each interval with, or NULL if
+ *                       only the actual time is being summed.
+ * @param totalMinutes   A pointer to the int storing the total minutes worked
+ *                       for the day. Left untouched unless the line was
+ *                       handled.
+ * @param roundedMinutes A pointer to the int storing the total of the rounded
+ *                       intervals, or NULL if roundInterval is. Left untouched
+ *                       unless the line was handled.
+ *
+ * @return The number of intervals summed if the line was handled, 0 if it must
+ *         be parsed the slow way.
+ */
+static PUNCHCARD_ALWAYS_INLINE int sumTimesInLineFast(
+        const char *line, const char *end, RoundingFunction roundInterval,
+        int *totalMinutes, int *roundedMinutes) {
+    /**
+     * The length of the line.
+     */
+    size_t length = (size_t) (end - line);
+
+    /**
+     * Where each delimiter appears in the line.
+     */
+    struct DelimiterMasks masks;
+
+    /**
+     * The start of the space between the previous time and the next one.
+     */
+    size_t gapStart = 0;
+
+    /**
+     * The number of times read so far.
+     */
+    int timesRead = 0;
+
+    /**
+     * The total minutes worked this day, kept aside until the line is handled.
+     */
+    int minutes = *totalMinutes;
+
+    /**
+     * The total of the rounded intervals, kept aside the same way.
+     */
+    int rounded = roundInterval != NULL ? *roundedMinutes : 0;
+
+    /**
+     * The last start time read, in minutes since midnight.
+     */
+    uint16_t start = 0;
+
+    if (length == 0 || length > FAST_LINE_SIZE) {
+        return 0;
+    }
+    findDelimiters(line, length, &masks);
+
+    // Decode the time around each colon in turn.
+    for (size_t word = 0; word < FAST_LINE_WORDS; word++) {
+        for (uint64_t colons = masks.colons[word]; colons != 0;
+             colons &= colons - 1) {
+            /**
+             * The position of the colon.
+             */
+            size_t colon = word * 64 + (size_t) lowestBit(colons);
+
+            /**
+             * The position of the first digit of the hour.
+             */
+            size_t first;
+
+            /**
+             * The delimiter expected in the gap before this time: none before
+             * the first, a hyphen before an end time, and a comma otherwise.
+             */
+            const uint64_t *delimiters = timesRead % 2 == 1 ? masks.hyphens :
+                                                              masks.commas;
+
+            /**
+             * The number of delimiters expected in the gap.
+             */
+            int expected = timesRead > 0;
+
+            int hour;
+            int minute;
+            char meridiem;
+
+            // Find where the hour starts and make sure the time is complete.
+            if (colon < gapStart + 1 || colon + 5 > length ||
+                (unsigned) (line[colon - 1] - '0') >= 10) {
+                return 0;
+            }
+            first = colon >= gapStart + 2 &&
+                    (unsigned) (line[colon - 2] - '0') < 10 ? colon - 2 :
+                                                              colon - 1;
+            if ((unsigned) (line[colon + 1] - '0') >= 10 ||
+                (unsigned) (line[colon + 2] - '0') >= 10 ||
+                ((masks.ms[(colon + 4) / 64] >> ((colon + 4) % 64)) & 1) == 0) {
+                return 0;
+            }
+
+            // The gap must hold only whitespace and the expected delimiter.
+            if (countMaskRange(delimiters, gapStart, first) != expected ||
+                countMaskRange(masks.spaces, gapStart, first) + expected !=
+                (int) (first - gapStart)) {
+                return 0;
+            }
+
+            // Decode the time, leaving anything invalid to the slow path.
+            hour = colon - first == 2 ?
+                   (line[first] - '0') * 10 + (line[first + 1] - '0') :
+                   line[first] - '0';
+            minute   = (line[colon + 1] - '0') * 10 + (line[colon + 2] - '0');
+            meridiem = (char) (line[colon + 3] | 0x20);
+            if (hour < 1 || hour > 12 || minute > 59 ||
+                (meridiem != 'a' && meridiem != 'p')) {
+                return 0;
+            }
+
+            // Keep start times, and add the difference at each end time.
+            if (timesRead % 2 == 0) {
+                start = toMinutes(hour, minute, meridiem);
+            } else {
+                /**
+                 * The minutes worked in this interval.
+                 */
+                int worked = difference(start,
+                                        toMinutes(hour, minute, meridiem));
+
+                minutes += worked;
+                if (roundInterval != NULL) {
+                    rounded += roundInterval(worked);
+                }
+            }
+            timesRead++;
+            gapStart = colon + 5;
+        }
+    }
+
+    // Every start time needs an end, with nothing but whitespace after it.
+    if (timesRead == 0 || timesRead % 2 != 0 ||
+        countMaskRange(masks.spaces, gapStart, length) !=
+        (int) (length - gapStart)) {
+        return 0;
+    }
+    *totalMinutes = minutes;
+    if (roundInterval != NULL) {
+        *roundedMinutes = rounded;
+    }
+    return timesRead / 2;
+}
+
+/**
+ * Reads every start and end time on a single line and sums the time worked,
+ * and the rounded time of each interval if asked to. Both sumTimesInLine() and
+ * sumRoundedTimesInLine() are built on this, and since it is inlined into each
+ * with roundInterval known, summing alone pays nothing for rounding, and each
+ * known rounding function is inlined rather than called for every interval.
+ *
+ * @param line           A pointer to the first character of the line.
+ * @param end            A pointer one past the last character of the line, not
+ *                       including the newline.
+ * @param roundInterval  The function to round each interval with, or NULL if
+ *                       only the actual time is being summed.
+ * @param totalMinutes   A pointer to the int storing the total minutes worked
+ *                       for the day.
+ * @param roundedMinutes A pointer to the int storing the total of the rounded
+ *                       intervals, or NULL if roundInterval is.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times.
+ */
+static PUNCHCARD_ALWAYS_INLINE int sumIntervalsInLine(
+        const char *line, const char *end, RoundingFunction roundInterval,
+        int *totalMinutes, int *roundedMinutes) {
+    /**
+     * The position in the line being read.
+     */
+    const char *cursor = line;
+
+    /**
+     * The return value of skipBufferJunk().
+     */
+    int endFound = 0;
+
+    /**
+     * The number of intervals read so far.
+     */
+    int count = sumTimesInLineFast(line, end, roundInterval, totalMinutes,
+                                   roundedMinutes);
+
+    // Most lines are regular enough to take the fast path.
+    if (count > 0) {
+        return count;
+    }
+
+    // While we haven't hit the end of the line...
+    while (endFound != 1 && endFound != -1) {
+        /**
+         * The hour work was started at.
+         */
+        int startHour;
+
+        /**
+         * The minute work was started at.
+         */
+        int startMinute;
+
+        /**
+         * The first character of the meridiem indicator for the time work was
+         * started at.
+         */
+        char startMeridiem;
+
+        /**
+         * The hour work ended at.
+         */
+        int endHour;
+
+        /**
+         * The minute work ended at.
+         */
+        int endMinute;
+
+        /**
+         * The first character of the meridiem indicator for the time work
+         * ended at.
+         */
+        char endMeridiem;
+
+        /**
+         * The minutes worked in this interval.
+         */
+        int worked;
+
+        // Read the start time, the hyphen, and the end time.
+        if (parseTime(&cursor, end, &startHour, &startMinute,
+                      &startMeridiem) != TIME_OK ||
+            skipBufferJunk(&cursor, end, '-') != 0 ||
+            parseTime(&cursor, end, &endHour, &endMinute,
+                      &endMeridiem) != TIME_OK) {
+            return -1;
+        }
+
+        // Add the difference between the two times.
+        worked = difference(toMinutes(startHour, startMinute, startMeridiem),
+                            toMinutes(endHour, endMinute, endMeridiem));
+        *totalMinutes += worked;
+        if (roundInterval != NULL) {
+            *roundedMinutes += roundInterval(worked);
+        }
+        count++;
+
+        // Move to the next time if possible.
+        endFound = skipBufferJunk(&cursor, end, ',');
+    }
+    return count;
+}
+
+/**
+ * Reads every start and end time on a single line of batch input and sums the
+ * time worked, the same way readTimesForDay() does for interactive input. A
+ * start time identical to its end time counts as no time worked, rather than
+ * ending the program.
+ *
+ * @param line         A pointer to the first character of the line.
+ * @param end          A pointer one past the last character of the line, not
+ *                     including the newline.
+ * @param totalMinutes A pointer to the int storing the total minutes worked for
+ *                     the day.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times.
+ */
+int sumTimesInLine(const char *line, const char *end, int *totalMinutes) {
+    return sumIntervalsInLine(line, end, NULL, totalMinutes, NULL);
+}
+
+/**
+ * Reads every start and end time on a single line and sums both the time
+ * worked and the time of each interval rounded on its own.
+ *
+ * @param line           A pointer to the first character of the line.
+ * @param end            A pointer one past the last character of the line, not
+ *                       including the newline.
+ * @param roundInterval  The function to round each interval with.
+ * @param totalMinutes   A pointer to the int storing the total minutes worked
+ *                       for the day.
+ * @param roundedMinutes A pointer to the int storing the total of the rounded
+ *                       intervals for the day.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times.
+ */
+int sumRoundedTimesInLine(const char *line, const char *end,
+                          RoundingFunction roundInterval, int *totalMinutes,
+                          int *roundedMinutes) {
+    // Check for each policy's own function once for the line, so its rounding
+    // is inlined into the copy of the loop made for it.
+#define SUM_ROUNDED_BY(name, policy, step, firstUp) \
+    if (roundInterval == round##name) { \
+        return sumIntervalsInLine(line, end, round##name, totalMinutes, \
+                                  roundedMinutes); \
+    }
+    ROUNDING_POLICIES(SUM_ROUNDED_BY)
+#undef SUM_ROUNDED_BY
+
+    return sumIntervalsInLine(line, end, roundInterval, totalMinutes,
+                              roundedMinutes);
+}
+
+/**
+ * Reads every start and end time on a single line one field at a time, where a
+ * field is everything up to the next comma, so that a field that can't be read
+ * is skipped rather than spoiling the whole line. Each field is read within its
+ * own commas, so this can split some unusual lines differently than
+ * sumTimesInLine() does; it is meant for lines that couldn't be read whole.
+ *
+ * @param line         A pointer to the first character of the line.
+ * @param end          A pointer one past the last character of the line, not
+ *                     including the newline.
+ * @param intervals    The array to store the start and end of each interval
+ *                     read in.
+ * @param skipped      The array to store the offset from the start of the line
+ *                     of each field skipped in.
+ * @param capacity     The most fields, read or skipped, the arrays have room
+ *                     for between them.
+ * @param skippedCount A pointer to the int storing the number of fields
+ *                     skipped.
+ *
+ * @return The number of intervals read, or -1 if the line has more than
+ *         capacity fields.
+ */
+int recoverIntervalsInLine(const char *line, const char *end,
+                           uint16_t (*intervals)[2], int *skipped,
+                           int capacity, int *skippedCount) {
+    /**
+     * The position in the line being read.
+     */
+    const char *cursor = line;
+
+    /**
+     * The number of intervals read so far.
+     */
+    int count = 0;
+
+    *skippedCount = 0;
+
+    // Read each field in turn, up to the last one on the line.
+    while (1) {
+        /**
+         * The comma ending the field, or the end of the line for the last.
+         */
+        const char *fieldEnd = memchr(cursor, ',', (size_t) (end - cursor));
+
+        /**
+         * The first character of the field other than whitespace.
+         */
+        const char *field;
+
+        int startHour;
+        int startMinute;
+        char startMeridiem;
+        int endHour;
+        int endMinute;
+        char endMeridiem;
+
+        if (fieldEnd == NULL) {
+            fieldEnd = end;
+        }
+        if (count + *skippedCount == capacity) {
+            return -1;
+        }
+        skipBufferSpace(&cursor, fieldEnd);
+        field = cursor;
+
+        // Keep the interval if the whole of it is there, and skip it if not.
+        if (parseTime(&cursor, fieldEnd, &startHour, &startMinute,
+                      &startMeridiem) == TIME_OK &&
+            skipBufferJunk(&cursor, fieldEnd, '-') == 0 &&
+            parseTime(&cursor, fieldEnd, &endHour, &endMinute,
+                      &endMeridiem) == TIME_OK) {
+            intervals[count][0] = toMinutes(startHour, startMinute,
+                                            startMeridiem);
+            intervals[count][1] = toMinutes(endHour, endMinute, endMeridiem);
+            count++;
+        } else {
+            skipped[(*skippedCount)++] = (int) (field - line);
+        }
+
+        // Move past the comma to the next field, if there is one.
+        if (fieldEnd == end) {
+            return count;
+        }
+        cursor = fieldEnd + 1;
+    }
+}
+
+/**
+ * Reads every start and end time on a single line the same way
+ * sumTimesInLine() does, stopping at the first problem, and says what it was.
+ * Only meant for lines already known to be unreadable, so it takes the slow
+ * path throughout.
+ *
+ * @param line A pointer to the first character of the line.
+ * @param end  A pointer one past the last character of the line, not including
+ *             the newline.
+ *
+ * @return TIME_OK if every time was read, otherwise every TimeError flag
+ *         describing the first time that couldn't be, or TIME_MALFORMED if a
+ *         start time wasn't followed by a hyphen.
+ */
+int findTimeErrors(const char *line, const char *end) {
+    /**
+     * The position in the line being read.
+     */
+    const char *cursor = line;
+
+    /**
+     * The return value of skipBufferJunk().
+     */
+    int endFound = 0;
+
+    // While we haven't hit the end of the line...
+    while (endFound != 1 && endFound != -1) {
+        int hour;
+        int minute;
+        char meridiem;
+
+        /**
+         * Everything wrong with the time read.
+         */
+        int errors = parseTime(&cursor, end, &hour, &minute, &meridiem);
+
+        // Read the start time, the hyphen, and the end time.
+        if (errors != TIME_OK) {
+            return errors;
+        }
+        if (skipBufferJunk(&cursor, end, '-') != 0) {
+            return TIME_MALFORMED;
+        }
+        errors = parseTime(&cursor, end, &hour, &minute, &meridiem);
+        if (errors != TIME_OK) {
+            return errors;
+        }
+
+        // Move to the next time if possible.
+        endFound = skipBufferJunk(&cursor, end, ',');
+    }
+    return TIME_OK;
+}
+
+/**
+ * Reads every start and end time on a single line of batch input and stores
+ * each as a pair of minutes since midnight, for the binary punch format.
+ *
+ * @param line      A pointer to the first character of the line.
+ * @param end       A pointer one past the last character of the line.
+ * @param intervals The array to store the start and end of each interval in.
+ * @param capacity  The most intervals the array has room for.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times or there were too many of them.
+ */
+int collectIntervalsInLine(const char *line, const char *end,
+                           uint16_t (*intervals)[2], int capacity) {
+    /**
+     * The position in the line being read.
+     */
+    const char *cursor = line;
+
+    /**
+     * The number of intervals read so far.
+     */
+    int count = 0;
+
+    /**
+     * The return value of skipBufferJunk().
+     */
+    int endFound = 0;
+
+    // While we haven't hit the end of the line...
+    while (endFound != 1 && endFound != -1) {
+        int startHour;
+        int startMinute;
+        char startMeridiem;
+        int endHour;
+        int endMinute;
+        char endMeridiem;
+
+        // Read the start time, the hyphen, and the end time.
+        if (count == capacity ||
+            parseTime(&cursor, end, &startHour, &startMinute,
+                      &startMeridiem) != TIME_OK ||
+            skipBufferJunk(&cursor, end, '-') != 0 ||
+            parseTime(&cursor, end, &endHour, &endMinute,
+                      &endMeridiem) != TIME_OK) {
+            return -1;
+        }
+
+        // Store both times as minutes since midnight.
+        intervals[count][0] = toMinutes(startHour, startMinute, startMeridiem);
+        intervals[count][1] = toMinutes(endHour, endMinute, endMeridiem);
+        count++;
+
+        // Move to the next time if possible.
+        endFound = skipBufferJunk(&cursor, end, ',');
+    }
+    return count;
+}
+
+/**
+ * Sorts the keys of up to MERGE_MAX_INTERVALS intervals in ascending order,
+ * through the sorting network if there are few enough of them, and by
+ * insertion otherwise.
+ *
+ * @param keys  The keys to sort, with room for at least NETWORK_SIZE.
+ * @param count The number of keys to sort.
+ */
+static void sortIntervalKeys(uint32_t *keys, int count) {
+    if (count <= NETWORK_SIZE) {
+        // Fill the unused places with keys that stay at the end.
+        for (int i = count; i < NETWORK_SIZE; i++) {
+            keys[i] = UINT32_MAX;
+        }
+        for (int i = 0; i < NETWORK_COMPARATORS; i++) {
+            /**
+             * The pair of keys being compared.
+             */
+            uint32_t first  = keys[sortingNetwork[i][0]];
+            uint32_t second = keys[sortingNetwork[i][1]];
+
+            keys[sortingNetwork[i][0]] = first < second ? first : second;
+            keys[sortingNetwork[i][1]] = first < second ? second : first;
+        }
+        return;
+    }
+
+    for (int i = 1; i < count; i++) {
+        /**
+         * The key being moved into place.
+         */
+        uint32_t key = keys[i];
+
+        /**
+         * Where the key is going.
+         */
+        int j = i;
+
+        while (j > 0 && keys[j - 1] > key) {
+            keys[j] = keys[j - 1];
+            j--;
+        }
+        keys[j] = key;
+    }
+}
+
+/**
+ * Sums a day's intervals, counting time covered by more than one of them only
+ * once. Each interval is laid out on a line running from the start of the day
+ * into the next, with an end earlier than its start falling on the next day,
+ * and the intervals are sorted by start. A single sweep then merges each into
+ * the one before it if they overlap.
+ *
+ * @param intervals The start and end of each interval, in minutes since
+ *                  midnight.
+ * @param count     The number of intervals, at most MERGE_MAX_INTERVALS.
+ * @param day       The struct MergedDay to store the totals in.
+ */
+void mergeIntervals(uint16_t (*intervals)[2], int count,
+                    struct MergedDay *day) {
+    /**
+     * Each interval worked, packed as its start in the upper 16 bits and its
+     * end in the lower 16, so sorting the keys sorts by start.
+     */
+    uint32_t keys[MERGE_MAX_INTERVALS];
+
+    /**
+     * The number of intervals with any time in them.
+     */
+    int kept = 0;
+
+    /**
+     * The start and end of the merged interval being built.
+     */
+    uint32_t start, stop;
+
+    day->minutes        = 0;
+    day->overlapMinutes = 0;
+    day->conflicts      = 0;
+    for (int i = 0; i < count; i++) {
+        /**
+         * The length of the interval.
+         */
+        int length = difference(intervals[i][0], intervals[i][1]);
+
+        if (length > 0) {
+            keys[kept++] = (uint32_t) intervals[i][0] << 16 |
+                           (uint32_t) (intervals[i][0] + length);
+        }
+    }
+    if (kept == 0) {
+        return;
+    }
+    sortIntervalKeys(keys, kept);
+
+    // Sweep across the day, merging each interval into the last if they
+    // overlap.
+    start = keys[0] >> 16;
+    stop  = keys[0] & 0xFFFF;
+    for (int i = 1; i < kept; i++) {
+        /**
+         * The start and end of this interval.
+         */
+        uint32_t nextStart = keys[i] >> 16, nextStop = keys[i] & 0xFFFF;
+
+        if (nextStart < stop) {
+            day->overlapMinutes += (int) ((nextStop < stop ? nextStop : stop) -
+                                          nextStart);
+            day->conflicts++;
+            if (nextStop > stop) {
+                stop = nextStop;
+            }
+        } else {
+            day->minutes += (int) (stop - start);
+            start = nextStart;
+            stop  = nextStop;
+        }
+    }
+    day->minutes += (int) (stop - start);
+}
+
+/**
+ * Reads every start and end time on a single line and sums the time worked,
+ * counting time covered by more than one interval only once.
+ *
+ * @param line A pointer to the first character of the line.
+ * @param end  A pointer one past the last character of the line, not including
+ *             the newline.
+ * @param day  The struct MergedDay to store the totals for the day in.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times or there were more than MERGE_MAX_INTERVALS of them.
+ */
+int mergeTimesInLine(const char *line, const char *end,
+                     struct MergedDay *day) {
+    /**
+     * The start and end of each interval on the line.
+     */
+    uint16_t intervals[MERGE_MAX_INTERVALS][2];
+
+    /**
+     * The number of intervals on the line.
+     */
+    int count = collectIntervalsInLine(line, end, intervals,
+                                       MERGE_MAX_INTERVALS);
+
+    if (count == -1) {
+        return -1;
+    }
+    mergeIntervals(intervals, count, day);
+    return count;
+}
+
+/**
+ * Sums the times on every line of a buffer, one day per line, until running
+ * out of lines or room for their totals. The last line need not end with a
+ * newline.
+ *
+ * @param begin    A pointer to the first character of the buffer.
+ * @param end      A pointer one past the last character of the buffer.
+ * @param days     The array to store the totals for each day in.
+ * @param capacity The most days the array has room for.
+ * @param rest     A pointer to the pointer to store the start of the first line
+ *                 not summed in, or NULL.
+ *
+ * @return The number of days summed.
+ */
+size_t sumDaysInBuffer(const char *begin, const char *end,
+                       struct DayTotal *days, size_t capacity,
+                       const char **rest) {
+    /**
+     * The start of the next line.
+     */
+    const char *cursor = begin;
+
+    /**
+     * The number of days summed so far.
+     */
+    size_t count = 0;
+
+    // Sum every line we have room for.
+    while (cursor < end && count < capacity) {
+        /**
+         * The newline ending the current line, if it has one.
+         */
+        const char *newline = memchr(cursor, '\n', (size_t) (end - cursor));
+
+        /**
+         * One past the last character of the current line.
+         */
+        const char *lineEnd = newline == NULL ? end : newline;
+
+        /**
+         * The total minutes worked this day.
+         */
+        int totalMinutes = 0;
+
+        // If something was wrong with the line, mark the day and move on.
+        if (sumTimesInLine(cursor, lineEnd, &totalMinutes) == -1) {
+            days[count].minutes        = -1;
+            days[count].roundedMinutes = -1;
+        } else {
+            days[count].minutes = totalMinutes;
+            roundTime(&totalMinutes);
+            days[count].roundedMinutes = totalMinutes;
+        }
+        count++;
+        cursor = newline == NULL ? end : newline + 1;
+    }
+
+    if (rest != NULL) {
+        *rest = cursor;
+    }
+    return count;
+}
+
+/**
+ * Writes a number in decimal, padded with leading zeroes to at least the given
+ * width the same way "%02d" would be. No null terminator is written.
+ *
+ * @param text  The buffer to write to, with room for NUMBER_TEXT_SIZE
+ *              characters.
+ * @param value The number to write.
+ * @param width The fewest digits to write.
+ *
+ * @return The number of characters written.
+ */
+size_t formatNumber(char *text, int value, int width) {
+    /**
+     * The digits of the number, filled in from the end.
+     */
+    char digits[NUMBER_TEXT_SIZE];
+
+    /**
+     * The position of the first digit filled in.
+     */
+    int first = (int) sizeof(digits);
+
+    /**
+     * The magnitude of the number, which can't overflow when negated.
+     */
+    unsigned magnitude = value < 0 ? 0u - (unsigned) value : (unsigned) value;
+
+    // Fill in the digits from least to most significant.
+    do {
+        digits[--first] = (char) ('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    while ((int) sizeof(digits) - first < width && first > 1) {
+        digits[--first] = '0';
+    }
+    if (value < 0) {
+        digits[--first] = '-';
+    }
+    memcpy(text, digits + first, sizeof(digits) - first);
+    return sizeof(digits) - first;
+}
+
+/**
+ * Writes a number of minutes as decimal hours with two places, the same way
+ * "%0.2f" would write them as a fraction of an hour. No null terminator is
+ * written. Everything is done in whole minutes, so the result is exact: a
+ * minute is never an odd number of thousandths of an hour, so no total ever
+ * lands halfway between two hundredths, and sums of totals written out never
+ * pick up binary rounding error the way sums of floating-point hours would.
+ *
+ * @param text    The buffer to write to, with room for NUMBER_TEXT_SIZE
+ *                characters.
+ * @param minutes The minutes to write.
+ *
+ * @return The number of characters written.
+ */
+size_t formatHours(char *text, int minutes) {
+    /**
+     * The minutes in excess of an hour as hundredths of an hour, rounded to
+     * the nearest.
+     */
+    int hundredths;
+
+    /**
+     * The number of characters written so far.
+     */
+    size_t length;
+
+    // Rounded totals can be copied straight out of the table.
+    if (minutes >= 0 && minutes % 15 == 0 &&
+        minutes / 15 < QUARTER_STRING_COUNT) {
+        length = minutes / 15 < 40 ? 4 : 5;
+        memcpy(text, quarterStrings[minutes / 15], length);
+        return length;
+    }
+
+    // Whole tenths of an hour, as the tenth-hour rounding policies give, end
+    // in a zero and need no dividing into hundredths.
+    if (minutes >= 0 && minutes % 6 == 0) {
+        length = formatNumber(text, minutes / 60, 1);
+        text[length++] = '.';
+        text[length++] = (char) ('0' + minutes % 60 / 6);
+        text[length++] = '0';
+        return length;
+    }
+
+    hundredths = (minutes % 60 * 100 + 30) / 60;
+    length = formatNumber(text, minutes / 60 + hundredths / 100, 1);
+    text[length++] = '.';
+    return length + formatNumber(text + length, hundredths % 100, 2);
+}
+
+/**
+ * Attempts to parse the next date in an in-memory buffer, in the ISO 8601
+ * format YYYY-MM-DD. Leading whitespace is skipped. The day count is found
+ * with the proleptic Gregorian calendar in 400-year eras, so no table of month
+ * lengths or loop over the years is needed.
+ *
+ * @param cursor A pointer to the pointer walking the buffer. On return, it
+ *               points just past the last character of the date.
+ * @param end    A pointer one past the last character of the buffer.
+ * @param date   A pointer to the int32_t storing the date, as the number of
+ *               days since 1970-01-01.
+ *
+ * @return 0 if a valid date was read, -1 otherwise.
+ */
+int parseDate(const char **cursor, const char *end, int32_t *date) {
+    /**
+     * The position in the buffer being read.
+     */
+    const char *position;
+
+    /**
+     * The digits of the date, in the order they are written.
+     */
+    int digits[8];
+
+    /**
+     * The year, month, and day of the date, with the year starting in March so
+     * that leap days fall at the end of it.
+     */
+    int year, month, day;
+
+    /**
+     * The 400-year era the year falls in, and the year and day within it.
+     */
+    int era, yearOfEra, dayOfEra;
+
+    skipBufferSpace(cursor, end);
+    position = *cursor;
+    if (end - position < DATE_TEXT_SIZE || position[4] != '-' ||
+        position[7] != '-') {
+        return -1;
+    }
+
+    // Pick out the eight digits around the two dashes.
+    for (int i = 0, j = 0; i < DATE_TEXT_SIZE; i++) {
+        if (i == 4 || i == 7) {
+            continue;
+        }
+        if ((unsigned) (position[i] - '0') >= 10) {
+            return -1;
+        }
+        digits[j++] = position[i] - '0';
+    }
+    year  = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    month = digits[4] * 10 + digits[5];
+    day   = digits[6] * 10 + digits[7];
+
+    // Check the day against the length of its month.
+    if (month < 1 || month > 12 || day < 1 ||
+        day > (month == 2 ? 28 + (year % 4 == 0 &&
+                                  (year % 100 != 0 || year % 400 == 0))
+                          : 30 + ((month + month / 8) & 1))) {
+        return -1;
+    }
+
+    // Round the era down, so January and February of year 0 fall in era -1.
+    year     -= month <= 2;
+    era       = (year >= 0 ? year : year - 399) / 400;
+    yearOfEra = year - era * 400;
+    dayOfEra  = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    dayOfEra += yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100;
+    *date     = era * 146097 + dayOfEra - 719468;
+    *cursor   = position + DATE_TEXT_SIZE;
+    return 0;
+}
+
+/**
+ * Writes a date in the ISO 8601 format YYYY-MM-DD. No null terminator is
+ * written.
+ *
+ * @param text The buffer to write to, with room for DATE_TEXT_SIZE characters.
+ * @param date The date to write, as the number of days since 1970-01-01, for a
+ *             year from 0 to 9999.
+ *
+ * @return The number of characters written.
+ */
+size_t formatDate(char *text, int32_t date) {
+    /**
+     * The date counted from 0000-03-01, the start of a 400-year era.
+     */
+    int32_t days = date + 719468;
+
+    /**
+     * The 400-year era the date falls in, and the year and day within it.
+     */
+    int era, yearOfEra, dayOfEra;
+
+    /**
+     * The day of the year counted from March, and the month counted from it.
+     */
+    int dayOfYear, shiftedMonth;
+
+    /**
+     * The year, month, and day of the date.
+     */
+    int year, month, day;
+
+    // Round the era down, so January and February of year 0 fall in era -1.
+    era          = (days >= 0 ? days : days - 146096) / 146097;
+    dayOfEra     = days - era * 146097;
+    yearOfEra    = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 -
+                    dayOfEra / 146096) / 365;
+    dayOfYear    = dayOfEra - (365 * yearOfEra + yearOfEra / 4 -
+                               yearOfEra / 100);
+    shiftedMonth = (5 * dayOfYear + 2) / 153;
+    day          = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    month        = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    year         = yearOfEra + era * 400 + (month <= 2);
+
+    formatNumber(text, year, 4);
+    text[4] = '-';
+    formatNumber(text + 5, month, 2);
+    text[7] = '-';
+    formatNumber(text + 8, day, 2);
+    return DATE_TEXT_SIZE;
+}
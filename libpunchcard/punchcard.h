@@ -0,0 +1,485 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details The core of PUNCHCARD as a library: reading times out of a buffer,
+ * summing the time worked between them, and rounding the totals to the nearest
+ * quarter-hour. Nothing here reads or writes any file, keeps any state between
+ * calls, or allocates any memory, so it can be called from any number of
+ * threads at once on buffers the caller owns.
+ */
+
+#ifndef PUNCHCARD_H
+#define PUNCHCARD_H
+
+// Libraries in use:
+#include <stddef.h>
+#include <stdint.h>
+
+// Constants
+/**
+ * The number of minutes in a day.
+ */
+#define MINUTES_PER_DAY 1440
+
+/**
+ * The most characters formatNumber() or formatHours() will write.
+ */
+#define NUMBER_TEXT_SIZE 16
+
+/**
+ * The number of characters formatDate() writes.
+ */
+#define DATE_TEXT_SIZE 10
+
+/**
+ * The most intervals mergeIntervals() and mergeTimesInLine() will merge for a
+ * single day.
+ */
+#define MERGE_MAX_INTERVALS 64
+
+/**
+ * Marks a function to be inlined everywhere it is called, however large, so
+ * the constants passed to it are folded into each copy.
+ */
+#if defined(_MSC_VER)
+#define PUNCHCARD_ALWAYS_INLINE __forceinline
+#else
+#define PUNCHCARD_ALWAYS_INLINE inline __attribute__((always_inline))
+#endif
+
+// Types
+/**
+ * Flags describing what can be wrong with a time read by parseTime().
+ */
+enum TimeError {
+    TIME_OK               = 0,
+    TIME_HOUR_TOO_SMALL   = 1 << 0,
+    TIME_HOUR_TOO_BIG     = 1 << 1,
+    TIME_MINUTE_TOO_SMALL = 1 << 2,
+    TIME_MINUTE_TOO_BIG   = 1 << 3,
+    TIME_BAD_MERIDIEM     = 1 << 4,
+    TIME_MALFORMED        = 1 << 5,
+};
+
+/**
+ * The ways a total of minutes worked can be rounded, each with its own
+ * function. The nearest quarter-hour is the usual "7/8-minute rule": up to 7
+ * minutes past a quarter rounds down, and 8 or more rounds up. The nearest
+ * tenth of an hour works the same way in 6-minute steps, rounding up from 3.
+ */
+enum RoundingPolicy {
+    ROUND_QUARTER_HOUR,
+    ROUND_QUARTER_HOUR_DOWN,
+    ROUND_TENTH_HOUR,
+    ROUND_TENTH_HOUR_DOWN,
+};
+
+/**
+ * Each rounding policy, as X(name, policy, step, firstUp): the name of its
+ * function after "round", its enum RoundingPolicy, and the step and threshold
+ * it passes to roundToStep(). A loop over many totals can be written once and
+ * copied for each policy with this, so the policy is picked once, outside the
+ * loop, and every total is rounded inline with a constant step.
+ */
+#define ROUNDING_POLICIES(X) \
+    X(QuarterHour, ROUND_QUARTER_HOUR, 15, 8) \
+    X(QuarterHourDown, ROUND_QUARTER_HOUR_DOWN, 15, 15) \
+    X(TenthHour, ROUND_TENTH_HOUR, 6, 3) \
+    X(TenthHourDown, ROUND_TENTH_HOUR_DOWN, 6, 6)
+
+/**
+ * A function rounding a total of minutes worked, as returned by
+ * findRoundingFunction().
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+typedef int (*RoundingFunction)(int minutes);
+
+/**
+ * The totals for a single day of times, as found by sumDaysInBuffer().
+ */
+struct DayTotal {
+    /**
+     * The total minutes worked, or -1 if any of the times could not be read.
+     */
+    int minutes;
+
+    /**
+     * The total minutes worked rounded to the nearest quarter-hour, or -1 if
+     * any of the times could not be read.
+     */
+    int roundedMinutes;
+};
+
+/**
+ * The totals for a single day of times with overlapping intervals merged, as
+ * found by mergeIntervals().
+ */
+struct MergedDay {
+    /**
+     * The total minutes worked, counting time covered by more than one
+     * interval only once.
+     */
+    int minutes;
+
+    /**
+     * The minutes that would have been counted more than once if the
+     * intervals had simply been added up.
+     */
+    int overlapMinutes;
+
+    /**
+     * The number of intervals overlapping an earlier one.
+     */
+    int conflicts;
+};
+
+// Functions
+/**
+ * Consumes characters from an in-memory buffer until finding the end of the
+ * buffer, a newline, or the target character.
+ *
+ * @param cursor A pointer to the pointer walking the buffer. On return, it
+ *               points just past the character that stopped the scan.
+ * @param end    A pointer one past the last character of the buffer.
+ * @param target The target char to stop consuming characters after
+ *               encountering.
+ *
+ * @return -1 if stopped by the end of the buffer, 1 if stopped by a newline, 0
+ *         if stopped by the target character.
+ */
+int skipBufferJunk(const char **cursor, const char *end, char target);
+
+/**
+ * Skips any whitespace at the cursor.
+ *
+ * @param cursor A pointer to the pointer walking the buffer.
+ * @param end    A pointer one past the last character of the buffer.
+ */
+void skipBufferSpace(const char **cursor, const char *end);
+
+/**
+ * Attempts to parse the next time in an in-memory buffer, in the format
+ * HH:MMcc, where HH is the hour, MM is the minute, and cc is the meridiem
+ * indicator ("am" or "pm"). Whitespace is allowed around each part. Only the
+ * first character of the meridiem indicator is consumed.
+ *
+ * @param cursor   A pointer to the pointer walking the buffer. On return, it
+ *                 points just past the last character of the time.
+ * @param end      A pointer one past the last character of the buffer.
+ * @param hour     A pointer to the int storing the hour for this time.
+ * @param minute   A pointer to the int storing the minute for this time.
+ * @param meridiem A pointer to the char storing the meridiem indicator for this
+ *                 time, converted to lowercase.
+ *
+ * @return TIME_OK if a valid time was read, otherwise every TimeError flag
+ *         describing what was wrong with the read time.
+ */
+int parseTime(const char **cursor, const char *end, int *hour, int *minute,
+              char *meridiem);
+
+/**
+ * Converts a 12-hour time to the number of minutes since midnight. 12am is
+ * midnight and 12pm is noon.
+ *
+ * @param hour     The hour of the time to convert (12-hour time).
+ * @param minute   The minute of the time to convert.
+ * @param meridiem The first character of the meridiem indicator for the time
+ *                 to convert ('a' or 'p').
+ *
+ * @return The number of minutes since midnight, from 0 to 1439.
+ */
+uint16_t toMinutes(int hour, int minute, char meridiem);
+
+/**
+ * Calculates the time worked between a start time and an end time. An end time
+ * earlier than the start time is taken to be on the following day.
+ *
+ * @param start The time work was started at, in minutes since midnight.
+ * @param end   The time work ended at, in minutes since midnight.
+ *
+ * @return The number of minutes worked, from 0 to 1439.
+ */
+int difference(uint16_t start, uint16_t end);
+
+/**
+ * Rounds minutes to a multiple of a step. Each rounding function passes its
+ * step and threshold as constants, so once this is inlined the division is
+ * done by multiplying and nothing about the policy is looked up at run time.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ * @param step    The minutes to round to a multiple of.
+ * @param firstUp The fewest minutes past a multiple that round up to the next
+ *                one, or step to always round down.
+ *
+ * @return The rounded minutes.
+ */
+static inline int roundToStep(int minutes, int step, int firstUp) {
+    return (minutes + step - firstUp) / step * step;
+}
+
+/**
+ * Rounds the total time worked to the nearest quarter-hour.
+ *
+ * @param totalMinutes A pointer to the int storing the total minutes worked.
+ */
+void roundTime(int *totalMinutes);
+
+/**
+ * Rounds minutes worked to the nearest quarter-hour, as roundTime() does.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundQuarterHour(int minutes);
+
+/**
+ * Rounds minutes worked down to the last whole quarter-hour.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundQuarterHourDown(int minutes);
+
+/**
+ * Rounds minutes worked to the nearest tenth of an hour.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundTenthHour(int minutes);
+
+/**
+ * Rounds minutes worked down to the last whole tenth of an hour.
+ *
+ * @param minutes The minutes to round, 0 or more.
+ *
+ * @return The rounded minutes.
+ */
+int roundTenthHourDown(int minutes);
+
+/**
+ * Finds the function for a rounding policy, so it can be looked up once and
+ * called directly for every total after.
+ *
+ * @param policy The rounding policy.
+ *
+ * @return The function rounding minutes by the policy, or NULL if there is no
+ *         such policy.
+ */
+RoundingFunction findRoundingFunction(enum RoundingPolicy policy);
+
+/**
+ * Reads every start and end time on a single line and sums the time worked. A
+ * start time identical to its end time counts as no time worked.
+ *
+ * @param line         A pointer to the first character of the line.
+ * @param end          A pointer one past the last character of the line, not
+ *                     including the newline.
+ * @param totalMinutes A pointer to the int storing the total minutes worked for
+ *                     the day.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times.
+ */
+int sumTimesInLine(const char *line, const char *end, int *totalMinutes);
+
+/**
+ * Reads every start and end time on a single line and sums the time worked
+ * the same way sumTimesInLine() does, while also summing the time of each
+ * interval rounded on its own, for sites that round every interval rather than
+ * the day.
+ *
+ * @param line           A pointer to the first character of the line.
+ * @param end            A pointer one past the last character of the line, not
+ *                       including the newline.
+ * @param roundInterval  The function to round each interval with.
+ * @param totalMinutes   A pointer to the int storing the total minutes worked
+ *                       for the day.
+ * @param roundedMinutes A pointer to the int storing the total of the rounded
+ *                       intervals for the day.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times.
+ */
+int sumRoundedTimesInLine(const char *line, const char *end,
+                          RoundingFunction roundInterval, int *totalMinutes,
+                          int *roundedMinutes);
+
+/**
+ * Reads every start and end time on a single line one field at a time, where a
+ * field is everything up to the next comma, skipping any field that can't be
+ * read rather than giving up on the line. Meant for lines sumTimesInLine()
+ * couldn't read, to save what can be saved of them.
+ *
+ * @param line         A pointer to the first character of the line.
+ * @param end          A pointer one past the last character of the line, not
+ *                     including the newline.
+ * @param intervals    The array to store the start and end of each interval
+ *                     read in, as minutes since midnight.
+ * @param skipped      The array to store the offset from the start of the line
+ *                     of each field skipped in.
+ * @param capacity     The most fields, read or skipped, the arrays have room
+ *                     for between them.
+ * @param skippedCount A pointer to the int storing the number of fields
+ *                     skipped.
+ *
+ * @return The number of intervals read, or -1 if the line has more than
+ *         capacity fields.
+ */
+int recoverIntervalsInLine(const char *line, const char *end,
+                           uint16_t (*intervals)[2], int *skipped,
+                           int capacity, int *skippedCount);
+
+/**
+ * Reads every start and end time on a single line the same way
+ * sumTimesInLine() does, stopping at the first problem, and says what it was,
+ * for explaining or counting why a line couldn't be summed.
+ *
+ * @param line A pointer to the first character of the line.
+ * @param end  A pointer one past the last character of the line, not including
+ *             the newline.
+ *
+ * @return TIME_OK if every time was read, otherwise every TimeError flag
+ *         describing the first time that couldn't be, or TIME_MALFORMED if a
+ *         start time wasn't followed by a hyphen.
+ */
+int findTimeErrors(const char *line, const char *end);
+
+/**
+ * Reads every start and end time on a single line and stores each as a pair of
+ * minutes since midnight.
+ *
+ * @param line      A pointer to the first character of the line.
+ * @param end       A pointer one past the last character of the line.
+ * @param intervals The array to store the start and end of each interval in.
+ * @param capacity  The most intervals the array has room for.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times or there were too many of them.
+ */
+int collectIntervalsInLine(const char *line, const char *end,
+                           uint16_t (*intervals)[2], int capacity);
+
+/**
+ * Sums a day's intervals, counting time covered by more than one of them only
+ * once. An end earlier than its start is taken to be on the following day, and
+ * a start identical to its end counts as no time worked. The intervals are
+ * sorted and merged on the stack, with no memory allocated.
+ *
+ * @param intervals The start and end of each interval, in minutes since
+ *                  midnight.
+ * @param count     The number of intervals, at most MERGE_MAX_INTERVALS.
+ * @param day       The struct MergedDay to store the totals in.
+ */
+void mergeIntervals(uint16_t (*intervals)[2], int count,
+                    struct MergedDay *day);
+
+/**
+ * Reads every start and end time on a single line and sums the time worked,
+ * counting time covered by more than one interval only once.
+ *
+ * @param line A pointer to the first character of the line.
+ * @param end  A pointer one past the last character of the line, not including
+ *             the newline.
+ * @param day  The struct MergedDay to store the totals for the day in.
+ *
+ * @return The number of intervals read, or -1 if there was an issue reading any
+ *         of the times or there were more than MERGE_MAX_INTERVALS of them.
+ */
+int mergeTimesInLine(const char *line, const char *end,
+                     struct MergedDay *day);
+
+/**
+ * Sums the times on every line of a buffer, one day per line, until running
+ * out of lines or room for their totals. The last line need not end with a
+ * newline.
+ *
+ * @param begin    A pointer to the first character of the buffer.
+ * @param end      A pointer one past the last character of the buffer.
+ * @param days     The array to store the totals for each day in.
+ * @param capacity The most days the array has room for.
+ * @param rest     A pointer to the pointer to store the start of the first line
+ *                 not summed in, or NULL.
+ *
+ * @return The number of days summed.
+ */
+size_t sumDaysInBuffer(const char *begin, const char *end,
+                       struct DayTotal *days, size_t capacity,
+                       const char **rest);
+
+/**
+ * Writes a number in decimal, padded with leading zeroes to at least the given
+ * width the same way "%02d" would be. No null terminator is written.
+ *
+ * @param text  The buffer to write to, with room for NUMBER_TEXT_SIZE
+ *              characters.
+ * @param value The number to write.
+ * @param width The fewest digits to write.
+ *
+ * @return The number of characters written.
+ */
+size_t formatNumber(char *text, int value, int width);
+
+/**
+ * Writes a number of minutes as decimal hours with two places, the same way
+ * "%0.2f" would write them as a fraction of an hour. No null terminator is
+ * written. Only integer arithmetic is used, so the result is exact for every
+ * number of minutes.
+ *
+ * @param text    The buffer to write to, with room for NUMBER_TEXT_SIZE
+ *                characters.
+ * @param minutes The minutes to write.
+ *
+ * @return The number of characters written.
+ */
+size_t formatHours(char *text, int minutes);
+
+/**
+ * Attempts to parse the next date in an in-memory buffer, in the ISO 8601
+ * format YYYY-MM-DD. Leading whitespace is skipped.
+ *
+ * @param cursor A pointer to the pointer walking the buffer. On return, it
+ *               points just past the last character of the date.
+ * @param end    A pointer one past the last character of the buffer.
+ * @param date   A pointer to the int32_t storing the date, as the number of
+ *               days since 1970-01-01.
+ *
+ * @return 0 if a valid date was read, -1 otherwise.
+ */
+int parseDate(const char **cursor, const char *end, int32_t *date);
+
+/**
+ * Writes a date in the ISO 8601 format YYYY-MM-DD. No null terminator is
+ * written.
+ *
+ * @param text The buffer to write to, with room for DATE_TEXT_SIZE characters.
+ * @param date The date to write, as the number of days since 1970-01-01, for a
+ *             year from 0 to 9999.
+ *
+ * @return The number of characters written.
+ */
+size_t formatDate(char *text, int32_t date);
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details Regression tests for the batch mode functions of PUNCHCARD. Each
+ * case runs input through them and checks the result lines and counters against
+ * what they should be, printing every case that doesn't match, and exits with a
+ * failure if any didn't.
+ */
+
+// The front end, for its batch mode functions, which brings libpunchcard in
+// with it.
+#define PUNCHCARD_NO_MAIN
+#include "../PUNCHCARD.c"
+
+// Libraries in use:
+#include <stdio.h>
+
+// Types
+/**
+ * A run of binary punch records, and what batch mode should write for them.
+ */
+struct BinaryCase {
+    /**
+     * The bytes of the records, with no header.
+     */
+    const char *bytes;
+
+    /**
+     * The number of bytes in the records.
+     */
+    size_t size;
+
+    /**
+     * Whether to merge overlapping intervals.
+     */
+    int mergeOverlaps;
+
+    /**
+     * The result lines batch mode should write.
+     */
+    const char *expected;
+
+    /**
+     * The number of records that should be counted as errors.
+     */
+    uint64_t errorLines;
+};
+
+// Constants
+/**
+ * The records to process, including times past the end of the day that no line
+ * of text could give.
+ */
+static const struct BinaryCase BINARY_CASES[] = {
+    {"\x01\x00" "\x1C\x02" "\xFC\x03", 6, 0, "08:00\t8.00\n", 0},
+    {"\x01\x00" "\x00\x00" "\x9F\x05", 6, 0, "23:59\t24.00\n", 0},
+    {"\x01\x00" "\x60\xEA" "\x64\x00", 6, 0, "ERROR\n", 1},
+    {"\x01\x00" "\xA0\x05" "\x00\x00", 6, 0, "ERROR\n", 1},
+    {"\x02\x00" "\xFF\xFF" "\x0A\x00" "\x00\x00" "\x88\x13", 10, 0, "ERROR\n",
+     1},
+    {"\x02\x00" "\xFF\xFF" "\x0A\x00" "\x00\x00" "\x88\x13", 10, 1, "ERROR\n",
+     1},
+    {"\xFF\xFF" "\x01\x00" "\x60\xEA" "\x64\x00" "\x01\x00" "\x1C\x02"
+     "\xFC\x03", 14, 1, "ERROR\nERROR\n08:00\t8.00\n", 2}
+};
+
+// Functions
+/**
+ * Runs every test case.
+ *
+ * @return 0 if every case passed, 1 otherwise.
+ */
+int main(void) {
+    /**
+     * The number of cases that didn't pass.
+     */
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(BINARY_CASES) / sizeof(*BINARY_CASES); i++) {
+        /**
+         * The case being run.
+         */
+        const struct BinaryCase *test = &BINARY_CASES[i];
+
+        /**
+         * The counters the case adds to.
+         */
+        struct Counters counters = {0};
+
+        /**
+         * The buffer collecting the result lines, with no file behind it.
+         */
+        struct OutputBuffer output;
+
+        /**
+         * The first record left unprocessed.
+         */
+        const char *rest;
+
+        if (outputOpen(&output, NULL, OUTPUT_BUFFER_SIZE) == -1) {
+            printf("FAILED\tOUT OF MEMORY\n");
+            return 1;
+        }
+        output.counters = &counters;
+        rest = processBinaryRecords(test->bytes, test->bytes + test->size,
+                                    test->mergeOverlaps, &output);
+        if (rest != test->bytes + test->size ||
+            output.length != strlen(test->expected) ||
+            memcmp(output.data, test->expected, output.length) != 0 ||
+            counters.errorLines != test->errorLines) {
+            printf("FAILED\tprocessBinaryRecords(case %zu)\n", i);
+            failures++;
+        }
+        outputClose(&output);
+    }
+    return failures > 0;
+}
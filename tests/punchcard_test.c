@@ -0,0 +1,518 @@
+/**
+ * PUNCHCARD - A command-line utility for determining self-reported work hours.
+ * Copyright (C) 2025  Sam K
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>. 
+ */
+
+/**
+ * @details Regression tests for libpunchcard. Each case reads a time or a line
+ * and checks the result against what it should be, printing every case that
+ * doesn't match, and exits with a failure if any didn't.
+ */
+
+// Libraries in use:
+#include "punchcard.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Constants
+/**
+ * The most fields, read or skipped, recoverIntervalsInLine() is given room for.
+ */
+#define RECOVER_CAPACITY 4
+
+// Types
+/**
+ * A single time to parse, and what parsing it should give.
+ */
+struct TimeCase {
+    /**
+     * The text of the time.
+     */
+    const char *text;
+
+    /**
+     * Every TimeError flag parsing it should return.
+     */
+    int errors;
+
+    /**
+     * The time in minutes since midnight, if it is valid.
+     */
+    int minutes;
+};
+
+/**
+ * A single line to sum, and the minutes summing it should give.
+ */
+struct LineCase {
+    /**
+     * The text of the line.
+     */
+    const char *text;
+
+    /**
+     * The minutes worked on the line, or -1 if it can't be read.
+     */
+    int minutes;
+};
+
+/**
+ * A single line to merge, and the totals merging it should give.
+ */
+struct MergeCase {
+    /**
+     * The text of the line.
+     */
+    const char *text;
+
+    /**
+     * The number of intervals on the line, or -1 if it can't be merged.
+     */
+    int count;
+
+    /**
+     * The minutes worked, counting overlapping time once.
+     */
+    int minutes;
+
+    /**
+     * The minutes covered by more than one interval.
+     */
+    int overlapMinutes;
+
+    /**
+     * The number of intervals overlapping an earlier one.
+     */
+    int conflicts;
+};
+
+/**
+ * A single line to recover what can be read of, and what should be.
+ */
+struct RecoverCase {
+    /**
+     * The text of the line.
+     */
+    const char *text;
+
+    /**
+     * The number of intervals read, or -1 if the line has too many fields.
+     */
+    int count;
+
+    /**
+     * The minutes worked in the intervals read.
+     */
+    int minutes;
+
+    /**
+     * The number of fields skipped.
+     */
+    int skippedCount;
+
+    /**
+     * The column of each field skipped, counting from 1.
+     */
+    int skipped[RECOVER_CAPACITY];
+};
+
+/**
+ * A single line that may not be readable, and why.
+ */
+struct ErrorCase {
+    /**
+     * The text of the line.
+     */
+    const char *text;
+
+    /**
+     * Every TimeError flag for the first time that can't be read.
+     */
+    int errors;
+};
+
+/**
+ * A single date to parse and write back out, and the day it falls on.
+ */
+struct DateCase {
+    /**
+     * The text of the date.
+     */
+    const char *text;
+
+    /**
+     * The number of days since 1970-01-01.
+     */
+    int32_t date;
+};
+
+// Tables
+/**
+ * The times to parse, including the spaced meridiems scanf_s() accepted.
+ */
+static const struct TimeCase TIME_CASES[] = {
+    {"9:00am", TIME_OK, 540},
+    {"12:30pm", TIME_OK, 750},
+    {"9:00 am", TIME_OK, 540},
+    {"5:00 pm", TIME_OK, 1020},
+    {"12:00 am", TIME_OK, 0},
+    {" 9 : 00 pm", TIME_OK, 1260},
+    {"9:000am", TIME_OK, 540},
+    {"12:345pm", TIME_MINUTE_TOO_BIG, 0},
+    {"13:00pm", TIME_HOUR_TOO_BIG, 0},
+    {"9:00xm", TIME_BAD_MERIDIEM, 0},
+    {"9:00 xm", TIME_BAD_MERIDIEM, 0},
+    {"9-00am", TIME_MALFORMED, 0}
+};
+
+/**
+ * The lines to sum, including spaced meridiems and the edges of the fast path:
+ * lines of 256 bytes, the longest it takes, and 257, times across the edge of
+ * a 32-byte window, and a line filling one window exactly.
+ */
+static const struct LineCase LINE_CASES[] = {
+    {"9:00am-5:00pm", 480},
+    {"9:00 am-5:00 pm", 480},
+    {"9:00 AM - 12:00 PM, 1:00 PM - 5:00 PM", 420},
+    {"9:00 am-5:00 xm", -1},
+    {"09:00am-10:00am, 09:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, "
+     "9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, "
+     "9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, "
+     "9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am", 960},
+    {"09:00am-10:00am, 09:00am-10:00am, 09:00am-10:00am, 9:00am-10:00am, "
+     "9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, "
+     "9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, "
+     "9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am, 9:00am-10:00am", 960},
+    {"8:00am-9:15am,10:00am-11:30am, 12:45pm-2:00pm, 3:10pm-4:20pm,  "
+     "5:00pm-6:00pm", 370},
+    {"10:00am-11:00am, 12:00pm-01:00pm", 120},
+    {"9:00am-12:30pm, 01:00pm-5:15pm", 465},
+    {"9:00am  -  5:00pm,  6:00pm-7:00pm", 540},
+    {"9:00am-5:00pm,", -1},
+    {"9:00am-5:00pm, 6:00pm-7:00pm, ", -1}
+};
+
+/**
+ * The lines to merge, including 8 intervals, the most the sorting network
+ * sorts, and 9, so both ways of sorting them are run.
+ */
+static const struct MergeCase MERGE_CASES[] = {
+    {"9:00am-12:00pm, 11:00am-1:00pm", 2, 240, 60, 1},
+    {"8:00am-5:00pm, 10:00am-11:00am", 2, 540, 60, 1},
+    {"9:00am-12:00pm, 12:00pm-1:00pm", 2, 240, 0, 0},
+    {"10:00pm-2:00am, 11:00pm-1:00am", 2, 240, 120, 1},
+    {"10:00pm-2:00am, 1:00am-3:00am", 2, 360, 0, 0},
+    {"4:00pm-5:00pm, 9:00am-10:00am, 1:00pm-2:00pm, 9:30am-11:00am, "
+     "3:00pm-4:00pm, 8:00am-9:00am, 1:30pm-1:45pm, 12:00pm-12:30pm",
+     8, 390, 45, 2},
+    {"4:00pm-5:00pm, 9:00am-10:00am, 1:00pm-2:00pm, 9:30am-11:00am, "
+     "3:00pm-4:00pm, 8:00am-9:00am, 1:30pm-1:45pm, 12:00pm-12:30pm, "
+     "4:30pm-6:00pm", 9, 450, 75, 3},
+    {"9:00am-5:00 xm, 10:00am-11:00am", -1, 0, 0, 0}
+};
+
+/**
+ * The lines to recover, skipping bad times, empty fields, and trailing commas.
+ */
+static const struct RecoverCase RECOVER_CASES[] = {
+    {"9:00am-1:00pm, 2:x0pm-4:30pm, 6:10pm-9:20pm", 2, 430, 1, {16}},
+    {"9:00am-5:00pm", 1, 480, 0, {0}},
+    {"x, y", 0, 0, 2, {1, 4}},
+    {"9:00am-5:00pm,, 6:00pm-7:00pm", 2, 540, 1, {15}},
+    {"13:00pm-1:00pm, 9:00am-10:00am, 9:00xm-1:00pm", 1, 60, 2, {1, 33}},
+    {"9:00am-10:00am,", 1, 60, 1, {16}},
+    {"a,b,c,d,e", -1, 0, 0, {0}}
+};
+
+/**
+ * The lines to explain, with one for each kind of TimeError.
+ */
+static const struct ErrorCase ERROR_CASES[] = {
+    {"9:00am-5:00pm", TIME_OK},
+    {"0:30am-5:00pm", TIME_HOUR_TOO_SMALL},
+    {"13:00pm-5:00pm", TIME_HOUR_TOO_BIG},
+    {"9:-5am-5:00pm", TIME_MINUTE_TOO_SMALL},
+    {"9:75am-5:00pm", TIME_MINUTE_TOO_BIG},
+    {"9:00xm-5:00pm", TIME_BAD_MERIDIEM},
+    {"9:00am 5:00pm", TIME_MALFORMED},
+    {"9am-5pm", TIME_MALFORMED},
+    {"9:00am-13:75xm",
+     TIME_HOUR_TOO_BIG | TIME_MINUTE_TOO_BIG | TIME_BAD_MERIDIEM},
+    {"9:00am-5:00pm, 6:00pm-7:x0pm", TIME_MALFORMED}
+};
+
+/**
+ * The dates to parse, including the start of year 0, before the first era.
+ */
+static const struct DateCase DATE_CASES[] = {
+    {"1970-01-01", 0},
+    {"2025-03-14", 20161},
+    {"2000-02-29", 11016},
+    {"0000-01-01", -719528},
+    {"0000-02-29", -719469},
+    {"0000-03-01", -719468},
+    {"9999-12-31", 2932896}
+};
+
+// Functions
+/**
+ * Runs every test case.
+ *
+ * @return 0 if every case passed, 1 otherwise.
+ */
+int main(void) {
+    /**
+     * The number of cases that didn't pass.
+     */
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(TIME_CASES) / sizeof(*TIME_CASES); i++) {
+        /**
+         * The case being run.
+         */
+        const struct TimeCase *test = &TIME_CASES[i];
+
+        /**
+         * The pointer walking the text of the time.
+         */
+        const char *cursor = test->text;
+
+        /**
+         * The hour parsed.
+         */
+        int hour;
+
+        /**
+         * The minute parsed.
+         */
+        int minute;
+
+        /**
+         * The first character of the meridiem indicator parsed.
+         */
+        char meridiem;
+
+        /**
+         * What parsing the time gave.
+         */
+        int errors = parseTime(&cursor, test->text + strlen(test->text),
+                               &hour, &minute, &meridiem);
+
+        if (errors != test->errors ||
+            (errors == TIME_OK &&
+             toMinutes(hour, minute, meridiem) != test->minutes)) {
+            printf("FAILED\tparseTime(\"%s\")\n", test->text);
+            failures++;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(LINE_CASES) / sizeof(*LINE_CASES); i++) {
+        /**
+         * The text of the line being summed.
+         */
+        const char *text = LINE_CASES[i].text;
+
+        /**
+         * The minutes summing the line gave.
+         */
+        int minutes = 0;
+
+        if (sumTimesInLine(text, text + strlen(text), &minutes) == -1) {
+            minutes = -1;
+        }
+        if (minutes != LINE_CASES[i].minutes) {
+            printf("FAILED\tsumTimesInLine(\"%s\")\n", text);
+            failures++;
+        }
+    }
+    for (size_t i = 0; i < sizeof(MERGE_CASES) / sizeof(*MERGE_CASES); i++) {
+        /**
+         * The case being run.
+         */
+        const struct MergeCase *test = &MERGE_CASES[i];
+
+        /**
+         * The merged totals.
+         */
+        struct MergedDay day = {0};
+
+        /**
+         * The number of intervals merging the line gave.
+         */
+        int count = mergeTimesInLine(test->text,
+                                     test->text + strlen(test->text), &day);
+
+        if (count != test->count ||
+            (count != -1 && (day.minutes != test->minutes ||
+                             day.overlapMinutes != test->overlapMinutes ||
+                             day.conflicts != test->conflicts))) {
+            printf("FAILED\tmergeTimesInLine(\"%s\")\n", test->text);
+            failures++;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(RECOVER_CASES) / sizeof(*RECOVER_CASES);
+         i++) {
+        /**
+         * The case being run.
+         */
+        const struct RecoverCase *test = &RECOVER_CASES[i];
+
+        /**
+         * The start and end of each interval read.
+         */
+        uint16_t intervals[RECOVER_CAPACITY][2];
+
+        /**
+         * The offset of each field skipped.
+         */
+        int skipped[RECOVER_CAPACITY];
+
+        /**
+         * The number of fields skipped.
+         */
+        int skippedCount = 0;
+
+        /**
+         * The minutes worked in the intervals read.
+         */
+        int minutes = 0;
+
+        /**
+         * The number of intervals read.
+         */
+        int count = recoverIntervalsInLine(test->text,
+                                           test->text + strlen(test->text),
+                                           intervals, skipped,
+                                           RECOVER_CAPACITY, &skippedCount);
+
+        /**
+         * Whether what was read is what should have been.
+         */
+        int passed = count == test->count;
+
+        for (int j = 0; passed && j < count; j++) {
+            minutes += difference(intervals[j][0], intervals[j][1]);
+        }
+        if (passed && count != -1) {
+            passed = minutes == test->minutes &&
+                     skippedCount == test->skippedCount;
+            for (int j = 0; passed && j < skippedCount; j++) {
+                passed = skipped[j] + 1 == test->skipped[j];
+            }
+        }
+        if (!passed) {
+            printf("FAILED\trecoverIntervalsInLine(\"%s\")\n", test->text);
+            failures++;
+        }
+    }
+    for (size_t i = 0; i < sizeof(ERROR_CASES) / sizeof(*ERROR_CASES); i++) {
+        /**
+         * The text of the line being explained.
+         */
+        const char *text = ERROR_CASES[i].text;
+
+        if (findTimeErrors(text, text + strlen(text)) !=
+            ERROR_CASES[i].errors) {
+            printf("FAILED\tfindTimeErrors(\"%s\")\n", text);
+            failures++;
+        }
+    }
+
+    // As many of the same interval as can be merged, then one too many.
+    for (int count = MERGE_MAX_INTERVALS; count <= MERGE_MAX_INTERVALS + 1;
+         count++) {
+        /**
+         * The line, the same interval over and over.
+         */
+        char text[(MERGE_MAX_INTERVALS + 1) * 16];
+
+        /**
+         * The length of the line so far.
+         */
+        size_t length = 0;
+
+        /**
+         * The merged totals.
+         */
+        struct MergedDay day = {0};
+
+        /**
+         * The number of intervals merging the line gave.
+         */
+        int merged;
+
+        for (int i = 0; i < count; i++) {
+            length += (size_t) snprintf(text + length, sizeof(text) - length,
+                                        "%s9:00am-10:00am", i > 0 ? "," : "");
+        }
+        merged = mergeTimesInLine(text, text + length, &day);
+        if (count > MERGE_MAX_INTERVALS ? merged != -1 :
+            merged != count || day.minutes != 60 ||
+            day.overlapMinutes != (count - 1) * 60 ||
+            day.conflicts != count - 1) {
+            printf("FAILED\tmergeTimesInLine(%d intervals)\n", count);
+            failures++;
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(DATE_CASES) / sizeof(*DATE_CASES); i++) {
+        /**
+         * The case being run.
+         */
+        const struct DateCase *test = &DATE_CASES[i];
+
+        /**
+         * The pointer walking the text of the date.
+         */
+        const char *cursor = test->text;
+
+        /**
+         * The date parsed.
+         */
+        int32_t date;
+
+        /**
+         * The date written back out.
+         */
+        char text[DATE_TEXT_SIZE];
+
+        if (parseDate(&cursor, test->text + DATE_TEXT_SIZE, &date) == -1 ||
+            date != test->date) {
+            printf("FAILED\tparseDate(\"%s\")\n", test->text);
+            failures++;
+        }
+        formatDate(text, test->date);
+        if (memcmp(text, test->text, DATE_TEXT_SIZE) != 0) {
+            printf("FAILED\tformatDate(%ld)\n", (long) test->date);
+            failures++;
+        }
+    }
+
+    // The copies made for each policy must round the same as its function.
+    for (int minutes = 0; minutes < 2 * MINUTES_PER_DAY; minutes++) {
+#define CHECK_ROUNDING(name, policy, step, firstUp) \
+        if (roundToStep(minutes, step, firstUp) != round##name(minutes) || \
+            findRoundingFunction(policy)(minutes) != round##name(minutes)) { \
+            printf("FAILED\tround" #name "(%d)\n", minutes); \
+            failures++; \
+        }
+        ROUNDING_POLICIES(CHECK_ROUNDING)
+#undef CHECK_ROUNDING
+    }
+    return failures > 0;
+}